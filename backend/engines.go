@@ -0,0 +1,273 @@
+package main
+
+import (
+	"cmp"
+	"encoding/json"
+	"errors"
+	"hash/fnv"
+	"net"
+	"net/http"
+	"net/url"
+	"slices"
+	"strconv"
+	"strings"
+	"sync"
+	"time"
+)
+
+// Game-affinity routing. Docker DNS round-robins across engine replicas, so
+// consecutive moves of one game would each land on a replica with a cold TT,
+// no session and no ponder search for that game. Instead every replica behind
+// ENGINE_URL is placed on a consistent-hash ring (weighted by the capacity it
+// reports on /route-info) and a game's calls go to the first replica clockwise
+// from the game's hash. If that replica can't be reached the call moves to the
+// next one on the ring, and when a replica disappears only its own games move.
+//
+// Affinity alone lets long searches pile onto one busy replica, so routing also
+// weighs load (power of two choices): of a game's first two replicas on the
+// ring, the second takes the call when the load it last reported (the
+// X-Engine-Load header on search responses, and GET /load polled every second)
+// costs clearly less than the first's. The margin keeps a game on its home
+// replica, with its session and warm TT, unless the difference is worth losing
+// them. Load older than loadStaleAfter is ignored.
+
+const (
+	ringRefreshInterval = 5 * time.Second
+	ringPointsPerSlot   = 16 // ring points per unit of reported capacity
+
+	loadRefreshInterval = time.Second
+	loadStaleAfter      = 5 * time.Second
+	loadSwitchMargin    = 500 // cost (ms) the second choice must save to take a game
+	healthPointCost     = 10  // cost (ms) of each point of health below 100
+)
+
+type engineMember struct {
+	id       string // replica_id from /route-info
+	url      string // base URL, e.g. http://172.18.0.5:8081
+	capacity int
+}
+
+type ringPoint struct {
+	hash   uint64
+	member int // index into engineRing.members
+}
+
+type engineRing struct {
+	mu      sync.RWMutex
+	members []engineMember
+	points  []ringPoint // sorted by hash
+
+	loads sync.Map // base URL -> *engineLoad; outlives ring rebuilds
+}
+
+// engineLoad is the latest load report from one replica.
+type engineLoad struct {
+	mu      sync.Mutex
+	waitMs  int // estimated_wait_ms
+	health  int // 0-100, 100 = idle
+	updated time.Time
+}
+
+var engines = &engineRing{}
+
+func init() {
+	go engines.maintain()
+	go engines.pollLoads()
+}
+
+func ringHash(s string) uint64 {
+	h := fnv.New64a()
+	h.Write([]byte(s))
+	return h.Sum64()
+}
+
+// urlsFor returns the engine base URLs to try for a game, in ring order. With no
+// replica discovered yet it falls back to ENGINE_URL, i.e. DNS round-robin.
+func (r *engineRing) urlsFor(gameID int) []string {
+	r.mu.RLock()
+	defer r.mu.RUnlock()
+	if len(r.points) == 0 {
+		return []string{engineURL()}
+	}
+	h := ringHash(strconv.Itoa(gameID))
+	start, _ := slices.BinarySearchFunc(r.points, h, func(p ringPoint, h uint64) int { return cmp.Compare(p.hash, h) })
+	urls := make([]string, 0, len(r.members))
+	seen := make([]bool, len(r.members))
+	for i := range r.points {
+		p := r.points[(start+i)%len(r.points)]
+		if !seen[p.member] {
+			seen[p.member] = true
+			urls = append(urls, r.members[p.member].url)
+		}
+	}
+	if len(urls) > 1 {
+		if home, next := r.cost(urls[0]), r.cost(urls[1]); home >= 0 && next >= 0 && next+loadSwitchMargin < home {
+			urls[0], urls[1] = urls[1], urls[0]
+		}
+	}
+	return urls
+}
+
+// cost ranks a replica by its last load report: the wait it estimated for a new
+// search plus a penalty for lost health. -1 when there is no fresh report.
+func (r *engineRing) cost(base string) int {
+	v, ok := r.loads.Load(base)
+	if !ok {
+		return -1
+	}
+	l := v.(*engineLoad)
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	if time.Since(l.updated) > loadStaleAfter {
+		return -1
+	}
+	return l.waitMs + (100-l.health)*healthPointCost
+}
+
+func (r *engineRing) setLoad(base string, waitMs, health int) {
+	v, _ := r.loads.LoadOrStore(base, &engineLoad{})
+	l := v.(*engineLoad)
+	l.mu.Lock()
+	l.waitMs, l.health, l.updated = waitMs, health, time.Now()
+	l.mu.Unlock()
+}
+
+// noteLoadHeader records the X-Engine-Load header ("wait_ms=120;health=62;...")
+// of a response from base, if it has one.
+func (r *engineRing) noteLoadHeader(base string, h http.Header) {
+	v := h.Get("X-Engine-Load")
+	if v == "" {
+		return
+	}
+	waitMs, health := -1, -1
+	for field := range strings.SplitSeq(v, ";") {
+		name, value, _ := strings.Cut(field, "=")
+		n, err := strconv.Atoi(value)
+		if err != nil {
+			continue
+		}
+		switch name {
+		case "wait_ms":
+			waitMs = n
+		case "health":
+			health = n
+		}
+	}
+	if waitMs >= 0 && health >= 0 {
+		r.setLoad(base, waitMs, health)
+	}
+}
+
+// pollLoads keeps every ring member's load fresh between the calls routed to it.
+func (r *engineRing) pollLoads() {
+	client := &http.Client{Timeout: time.Second}
+	for {
+		time.Sleep(loadRefreshInterval)
+		r.mu.RLock()
+		members := r.members
+		r.mu.RUnlock()
+		var wg sync.WaitGroup
+		for _, m := range members {
+			wg.Go(func() {
+				resp, err := client.Get(m.url + "/load")
+				if err != nil {
+					return
+				}
+				defer resp.Body.Close()
+				var load struct {
+					EstimatedWaitMs int `json:"estimated_wait_ms"`
+					Health          int `json:"health"`
+				}
+				if resp.StatusCode == http.StatusOK && json.NewDecoder(resp.Body).Decode(&load) == nil {
+					r.setLoad(m.url, load.EstimatedWaitMs, load.Health)
+				}
+			})
+		}
+		wg.Wait()
+	}
+}
+
+func (r *engineRing) maintain() {
+	client := &http.Client{Timeout: 2 * time.Second}
+	for {
+		r.refresh(client)
+		time.Sleep(ringRefreshInterval)
+	}
+}
+
+// refresh resolves every replica behind ENGINE_URL and rebuilds the ring from
+// the ones that answer /route-info. A failed lookup keeps the previous ring.
+func (r *engineRing) refresh(client *http.Client) {
+	base, err := url.Parse(engineURL())
+	if err != nil {
+		return
+	}
+	addrs, err := net.LookupHost(base.Hostname())
+	if err != nil || len(addrs) == 0 {
+		return
+	}
+
+	members := make([]engineMember, len(addrs))
+	var wg sync.WaitGroup
+	for i, addr := range addrs {
+		wg.Go(func() {
+			u := *base
+			u.Host = net.JoinHostPort(addr, base.Port())
+			resp, err := client.Get(u.String() + "/route-info")
+			if err != nil {
+				return
+			}
+			defer resp.Body.Close()
+			var info struct {
+				ReplicaID string `json:"replica_id"`
+				Capacity  int    `json:"capacity"`
+			}
+			if resp.StatusCode != http.StatusOK || json.NewDecoder(resp.Body).Decode(&info) != nil || info.ReplicaID == "" {
+				return
+			}
+			members[i] = engineMember{id: info.ReplicaID, url: u.String(), capacity: max(1, info.Capacity)}
+		})
+	}
+	wg.Wait()
+	members = slices.DeleteFunc(members, func(m engineMember) bool { return m.id == "" })
+	if len(members) == 0 {
+		return
+	}
+
+	// Points hash the replica id, not its address, so a replica keeps its games
+	// across restarts that change its IP.
+	var points []ringPoint
+	for mi, m := range members {
+		for v := range m.capacity * ringPointsPerSlot {
+			points = append(points, ringPoint{ringHash(m.id + "#" + strconv.Itoa(v)), mi})
+		}
+	}
+	slices.SortFunc(points, func(a, b ringPoint) int { return cmp.Compare(a.hash, b.hash) })
+
+	r.mu.Lock()
+	r.members, r.points = members, points
+	r.mu.Unlock()
+}
+
+// doEngineForGame sends a request to the game's replica, failing over along the
+// ring while replicas refuse connections; a busy home replica may be passed over
+// for the next one (see urlsFor). newReq builds the request for one base
+// URL; the body must be rebuilt per attempt. Only dial failures move on: once a
+// request was sent the replica may be acting on it, and an HTTP error status is
+// a real answer, so both are returned as is.
+func doEngineForGame(client *http.Client, gameID int, newReq func(base string) *http.Request) (*http.Response, error) {
+	var lastErr error
+	for _, base := range engines.urlsFor(gameID) {
+		resp, err := client.Do(newReq(base))
+		if err == nil {
+			engines.noteLoadHeader(base, resp.Header)
+			return resp, nil
+		}
+		lastErr = err
+		var opErr *net.OpError
+		if !errors.As(err, &opErr) || opErr.Op != "dial" {
+			break
+		}
+	}
+	return nil, lastErr
+}
@@ -5,6 +5,7 @@ import (
 	"bytes"
 	"database/sql"
 	"encoding/json"
+	"errors"
 	"fmt"
 	"net/http"
 	"os"
@@ -124,6 +125,10 @@ func getGameHandler(db *sql.DB) http.HandlerFunc {
 			jsonError(w, "not a participant", http.StatusForbidden)
 			return
 		}
+		// A bot reply that was given up on (or lost with a restart) resumes here.
+		if botToMove(g) {
+			resumeBotReply(db, g.ID, g.CurrentFEN)
+		}
 		writeJSON(w, http.StatusOK, g)
 	}
 }
@@ -165,6 +170,16 @@ var engineClient = &http.Client{
 	Timeout: 10 * time.Second,
 }
 
+// setEngineDeadline tells the engine how long this call will wait for its answer
+// (the client timeout, or less if the request context ends sooner), so searches
+// stop once nobody is left to read the result. See engine/Deadline.h.
+func setEngineDeadline(req *http.Request, timeout time.Duration) {
+	if d, ok := req.Context().Deadline(); ok {
+		timeout = min(timeout, time.Until(d))
+	}
+	req.Header.Set("X-Deadline-Ms", strconv.FormatInt(timeout.Milliseconds(), 10))
+}
+
 func engineURL() string {
 	if u := os.Getenv("ENGINE_URL"); u != "" {
 		return u
@@ -321,32 +336,83 @@ func moveHandler(db *sql.DB) http.HandlerFunc {
 			return
 		}
 
-		// Forward to C++ engine over the keep-alive pool.
-		payload, _ := json.Marshal(map[string]string{
-			"fen":      currentFEN,
-			"uci_move": body.UCIMove,
-		})
+		// Bot games go to /move-and-reply, which applies the human move and searches
+		// the bot's reply in a single engine request; its first SSE event carries
+		// the human move's result. Other games use /move over the keep-alive pool.
+		opponentID := blackID
+		if claims.UserID == blackID {
+			opponentID = whiteID
+		}
+		botGame := opponentID == 0
+
+		var resp *http.Response
 		globalMetrics.engineBegin()
 		engineStart := time.Now()
-		resp, err := engineClient.Post(engineURL()+"/move", "application/json", bytes.NewReader(payload))
+		if botGame {
+			// game_id lets the engine continue its warm session for this game;
+			// fen still goes along so any replica can (re)build one.
+			payload := map[string]any{
+				"fen":      currentFEN,
+				"game_id":  strconv.Itoa(body.GameID),
+				"uci_move": body.UCIMove,
+				"depth":    botDepth,
+				"noise":    botNoise,
+			}
+			if botTimeMs > 0 {
+				payload["time_ms"] = botTimeMs
+			}
+			turnPayload, _ := json.Marshal(payload)
+			searchClient := &http.Client{Timeout: 120 * time.Second}
+			resp, err = doEngineForGame(searchClient, body.GameID, func(base string) *http.Request {
+				req, _ := http.NewRequest(http.MethodPost, base+"/move-and-reply", bytes.NewReader(turnPayload))
+				req.Header.Set("Content-Type", "application/json")
+				req.Header.Set("X-Search-Priority", "bot")
+				setEngineDeadline(req, searchClient.Timeout)
+				return req
+			})
+		} else {
+			payload, _ := json.Marshal(map[string]string{
+				"fen":      currentFEN,
+				"uci_move": body.UCIMove,
+			})
+			resp, err = doEngineForGame(engineClient, body.GameID, func(base string) *http.Request {
+				req, _ := http.NewRequest(http.MethodPost, base+"/move", bytes.NewReader(payload))
+				req.Header.Set("Content-Type", "application/json")
+				setEngineDeadline(req, engineClient.Timeout)
+				return req
+			})
+		}
 		globalMetrics.engineEnd()
 		globalMetrics.recordEngine(time.Since(engineStart).Milliseconds(), err != nil)
 		if err != nil {
 			jsonError(w, "engine unreachable", http.StatusBadGateway)
 			return
 		}
-		defer resp.Body.Close()
+		// The reply stream is handed to finishBotReply once the human move is saved.
+		handedOff := false
+		defer func() {
+			if !handedOff {
+				resp.Body.Close()
+			}
+		}()
 
-		var engineResp struct {
-			Status    string `json:"status"`
-			GameState string `json:"game_state"`
-			NewFEN    string `json:"new_fen"`
-			Error     string `json:"error"`
-		}
-		if err := json.NewDecoder(resp.Body).Decode(&engineResp); err != nil {
+		var engineResp turnEvent
+		var scanner *bufio.Scanner
+		if botGame && resp.StatusCode == http.StatusOK {
+			scanner = bufio.NewScanner(resp.Body)
+			if !nextTurnEvent(scanner, &engineResp) {
+				jsonError(w, "invalid engine response", http.StatusBadGateway)
+				return
+			}
+		} else if err := json.NewDecoder(resp.Body).Decode(&engineResp); err != nil {
 			jsonError(w, "invalid engine response", http.StatusBadGateway)
 			return
 		}
+		if engineBusy(resp) {
+			w.Header().Set("Retry-After", resp.Header.Get("Retry-After"))
+			jsonError(w, "engine busy", http.StatusServiceUnavailable)
+			return
+		}
 		if resp.StatusCode != http.StatusOK {
 			jsonError(w, "engine error: "+engineResp.Error, http.StatusBadGateway)
 			return
@@ -357,59 +423,37 @@ func moveHandler(db *sql.DB) http.HandlerFunc {
 			return
 		}
 
-		// Persist new FEN, status, and move record atomically.
-		newStatus := "active"
-		switch engineResp.GameState {
-		case "CHECKMATE", "STALEMATE", "DRAW_50_MOVE", "DRAW_INSUFFICIENT":
-			newStatus = "finished"
-		}
-
-		tx, err := db.Begin()
-		if err != nil {
-			jsonError(w, "internal error", http.StatusInternalServerError)
-			return
-		}
-		defer tx.Rollback() //nolint:errcheck
-
-		// ply = number of moves already recorded + 1
-		var ply int
-		if err = tx.QueryRow(
-			`SELECT COUNT(*) + 1 FROM moves WHERE game_id = $1`, body.GameID,
-		).Scan(&ply); err != nil {
-			jsonError(w, "internal error", http.StatusInternalServerError)
-			return
-		}
-
-		if _, err = tx.Exec(
-			`UPDATE games SET current_fen = $1, status = $2 WHERE id = $3`,
-			engineResp.NewFEN, newStatus, body.GameID,
-		); err != nil {
-			jsonError(w, "internal error", http.StatusInternalServerError)
-			return
-		}
-
-		if _, err = tx.Exec(
-			`INSERT INTO moves (game_id, ply, uci, fen_after) VALUES ($1, $2, $3, $4)`,
-			body.GameID, ply, body.UCIMove, engineResp.NewFEN,
-		); err != nil {
-			jsonError(w, "internal error", http.StatusInternalServerError)
-			return
+		// Persist new FEN, status, and move record atomically. A bot reply is
+		// registered first, so GET /game never sees the bot's turn without it.
+		newStatus := gameStatus(engineResp.GameState)
+		var progress *BotProgress
+		if botGame && newStatus == "active" {
+			progress = &BotProgress{}
+			botThinking.Store(body.GameID, progress)
 		}
-
-		if err = tx.Commit(); err != nil {
+		if err := recordMove(db, body.GameID, body.UCIMove, currentFEN, engineResp.NewFEN, newStatus); err != nil {
+			if progress != nil {
+				botThinking.CompareAndDelete(body.GameID, progress)
+			}
+			if err == errStaleMove {
+				jsonError(w, "game changed, reload", http.StatusConflict)
+				return
+			}
 			jsonError(w, "internal error", http.StatusInternalServerError)
 			return
 		}
-		globalMetrics.recordDB(true) // UPDATE games
-		globalMetrics.recordDB(true) // INSERT moves
 
-		// If this is a bot game and the game is still active, fire the engine's reply.
-		opponentID := blackID
-		if claims.UserID == blackID {
-			opponentID = whiteID
-		}
-		if opponentID == 0 && newStatus == "active" {
-			go fireBotMove(db, body.GameID, engineResp.NewFEN, botDepth, botNoise, botTimeMs)
+		// If this is a bot game and the game is still active, the engine is already
+		// searching the reply on the same stream, unless its search lane was full:
+		// the human move still stands and the reply is searched again.
+		if progress != nil {
+			bot := botSearch{botDepth, botNoise, botTimeMs}
+			if !engineResp.Done {
+				handedOff = true
+				go finishBotReply(db, body.GameID, engineResp.NewFEN, bot, progress, resp, scanner)
+			} else {
+				go retryBotReply(db, body.GameID, engineResp.NewFEN, bot, progress, engineResp.RetryAfter)
+			}
 		}
 
 		writeJSON(w, http.StatusOK, map[string]string{
@@ -420,116 +464,249 @@ func moveHandler(db *sql.DB) http.HandlerFunc {
 	}
 }
 
-// fireBotMove calls the C++ engine's streaming endpoint to pick the best move,
-// updates botThinking progress as each depth completes, then persists the result.
-// Runs in a goroutine so it doesn't block the human player's HTTP response.
-func fireBotMove(db *sql.DB, gameID int, fen string, depth int, noise int, timeMs int) {
-	progress := &BotProgress{}
-	botThinking.Store(gameID, progress)
-	defer botThinking.Delete(gameID)
+// engineBusy reports whether the engine's search lane refused the request
+// (429 for shed hints, 503 when full); both carry Retry-After.
+func engineBusy(resp *http.Response) bool {
+	return resp.StatusCode == http.StatusTooManyRequests || resp.StatusCode == http.StatusServiceUnavailable
+}
 
-	payload := map[string]any{
-		"fen":   fen,
-		"depth": depth,
-		"noise": noise,
-	}
-	if timeMs > 0 {
-		payload["time_ms"] = timeMs
-	}
-	searchPayload, _ := json.Marshal(payload)
-	searchClient := &http.Client{Timeout: 120 * time.Second}
-	globalMetrics.engineBegin()
-	resp, err := searchClient.Post(engineURL()+"/search-stream", "application/json", bytes.NewReader(searchPayload))
-	if err != nil {
-		globalMetrics.engineEnd()
-		return
-	}
-	defer func() {
-		resp.Body.Close()
-		globalMetrics.engineEnd()
-	}()
+// turnEvent is one JSON object from the engine: a /move response, or an SSE
+// event of /move-and-reply (human result, per-depth progress, or the final event).
+type turnEvent struct {
+	Status       string `json:"status"`
+	GameState    string `json:"game_state"`
+	NewFEN       string `json:"new_fen"`
+	Error        string `json:"error"`
+	Depth        int    `json:"depth"`
+	BestMove     string `json:"best_move"`
+	Score        int    `json:"score"`
+	Nodes        int    `json:"nodes"`
+	Done         bool   `json:"done"`
+	BotFEN       string `json:"bot_fen"`
+	BotGameState string `json:"bot_game_state"`
+	RetryAfter   int    `json:"retry_after"`
+}
 
-	// Read SSE events and track the latest best move.
-	var bestMove string
-	scanner := bufio.NewScanner(resp.Body)
+// nextTurnEvent decodes the next SSE data event into ev. Returns false at end of stream.
+func nextTurnEvent(scanner *bufio.Scanner, ev *turnEvent) bool {
 	for scanner.Scan() {
 		line := scanner.Text()
 		if !strings.HasPrefix(line, "data: ") {
 			continue
 		}
-		jsonStr := strings.TrimPrefix(line, "data: ")
-		var ev struct {
-			Depth    int    `json:"depth"`
-			BestMove string `json:"best_move"`
-			Score    int    `json:"score"`
-			Nodes    int    `json:"nodes"`
-			Done     bool   `json:"done"`
-		}
-		if err := json.Unmarshal([]byte(jsonStr), &ev); err != nil {
+		*ev = turnEvent{}
+		if err := json.Unmarshal([]byte(strings.TrimPrefix(line, "data: ")), ev); err != nil {
 			continue
 		}
-		progress.mu.Lock()
-		progress.Depth = ev.Depth
-		progress.BestMove = ev.BestMove
-		progress.Score = ev.Score
-		progress.Nodes = ev.Nodes
-		progress.mu.Unlock()
+		return true
+	}
+	return false
+}
+
+// gameStatus maps an engine game_state to the games.status column.
+func gameStatus(gameState string) string {
+	switch gameState {
+	case "CHECKMATE", "STALEMATE", "DRAW_50_MOVE", "DRAW_INSUFFICIENT":
+		return "finished"
+	}
+	return "active"
+}
+
+// errStaleMove is returned by recordMove when the game moved on from fenBefore.
+var errStaleMove = errors.New("game is no longer at the move's position")
+
+// recordMove persists a validated move: the game's new FEN and status plus the
+// move record, in one transaction. The move is only applied while the game is
+// still at fenBefore, so a reply searched twice is recorded once.
+func recordMove(db *sql.DB, gameID int, uci, fenBefore, fenAfter, newStatus string) error {
+	tx, err := db.Begin()
+	if err != nil {
+		return err
+	}
+	defer tx.Rollback() //nolint:errcheck
+
+	// ply = number of moves already recorded + 1
+	var ply int
+	if err = tx.QueryRow(`SELECT COUNT(*) + 1 FROM moves WHERE game_id = $1`, gameID).Scan(&ply); err != nil {
+		return err
+	}
+	res, err := tx.Exec(`UPDATE games SET current_fen = $1, status = $2 WHERE id = $3 AND current_fen = $4 AND status = 'active'`,
+		fenAfter, newStatus, gameID, fenBefore)
+	if err != nil {
+		return err
+	}
+	if n, err := res.RowsAffected(); err != nil {
+		return err
+	} else if n == 0 {
+		return errStaleMove
+	}
+	if _, err = tx.Exec(`INSERT INTO moves (game_id, ply, uci, fen_after) VALUES ($1, $2, $3, $4)`, gameID, ply, uci, fenAfter); err != nil {
+		return err
+	}
+	if err = tx.Commit(); err != nil {
+		return err
+	}
+	globalMetrics.recordDB(true) // UPDATE games
+	globalMetrics.recordDB(true) // INSERT moves
+	return nil
+}
+
+// finishBotReply reads the rest of a /move-and-reply stream, updating botThinking
+// progress as each depth completes, then persists the bot's move from the final
+// event. The engine has already applied the move, so no second /move call is needed.
+// A stream that ends without a move falls back to retryBotReply.
+// Runs in a goroutine so it doesn't block the human player's HTTP response.
+func finishBotReply(db *sql.DB, gameID int, fen string, bot botSearch, progress *BotProgress,
+	resp *http.Response, scanner *bufio.Scanner) {
+	globalMetrics.engineBegin()
+	var ev turnEvent
+	for nextTurnEvent(scanner, &ev) {
+		progress.update(ev)
 		if ev.Done {
-			bestMove = ev.BestMove
+			break
 		}
 	}
+	resp.Body.Close()
+	globalMetrics.engineEnd()
 
-	if bestMove == "" {
+	if !ev.Done || ev.BestMove == "" || ev.BotFEN == "" {
+		retryBotReply(db, gameID, fen, bot, progress, ev.RetryAfter)
 		return
 	}
+	_ = recordMove(db, gameID, ev.BestMove, fen, ev.BotFEN, gameStatus(ev.BotGameState))
+	botThinking.CompareAndDelete(gameID, progress)
+}
 
-	// Validate and apply the bot's chosen move through the engine.
-	movePayload, _ := json.Marshal(map[string]string{
-		"fen":      fen,
-		"uci_move": bestMove,
-	})
-	globalMetrics.engineBegin()
-	botEngineStart := time.Now()
-	mresp, err := engineClient.Post(engineURL()+"/move", "application/json", bytes.NewReader(movePayload))
-	globalMetrics.engineEnd()
-	globalMetrics.recordEngine(time.Since(botEngineStart).Milliseconds(), err != nil)
+func (p *BotProgress) update(ev turnEvent) {
+	p.mu.Lock()
+	p.Depth = ev.Depth
+	p.BestMove = ev.BestMove
+	p.Score = ev.Score
+	p.Nodes = ev.Nodes
+	p.mu.Unlock()
+}
+
+// botSearch is a bot game's search settings (the games.bot_* columns).
+type botSearch struct {
+	Depth, Noise, TimeMs int
+}
+
+// botReplyPatience is how long retryBotReply keeps trying; after that the
+// reply waits for the next GET /game of the game (see resumeBotReply).
+const botReplyPatience = 2 * time.Minute
+
+// botToMove reports whether g is an active bot game waiting on the bot's move.
+func botToMove(g Game) bool {
+	if g.Status != "active" {
+		return false
+	}
+	color, err := activeColor(g.CurrentFEN)
 	if err != nil {
-		return
+		return false
 	}
-	defer mresp.Body.Close()
+	return (color == 'w' && g.WhiteID == 0) || (color == 'b' && g.BlackID == 0)
+}
 
-	var engineResp struct {
-		Status    string `json:"status"`
-		GameState string `json:"game_state"`
-		NewFEN    string `json:"new_fen"`
+// resumeBotReply starts searching the bot's reply to fen unless this backend is
+// already working on one for the game.
+func resumeBotReply(db *sql.DB, gameID int, fen string) {
+	progress := &BotProgress{}
+	if _, running := botThinking.LoadOrStore(gameID, progress); running {
+		return
 	}
-	if err := json.NewDecoder(mresp.Body).Decode(&engineResp); err != nil || engineResp.Status != "VALID" {
+	var bot botSearch
+	err := db.QueryRow(`SELECT bot_depth, bot_noise, bot_time_ms FROM games WHERE id = $1`, gameID).
+		Scan(&bot.Depth, &bot.Noise, &bot.TimeMs)
+	globalMetrics.recordDB(false)
+	if err != nil {
+		botThinking.CompareAndDelete(gameID, progress)
 		return
 	}
+	go retryBotReply(db, gameID, fen, bot, progress, 0)
+}
 
-	newStatus := "active"
-	switch engineResp.GameState {
-	case "CHECKMATE", "STALEMATE", "DRAW_50_MOVE", "DRAW_INSUFFICIENT":
-		newStatus = "finished"
+// retryBotReply searches the bot's reply to fen when /move-and-reply applied
+// the human move without one: the engine's search lane was full, or the stream
+// broke. Busy answers are retried after their Retry-After, other failures after
+// a few seconds, for botReplyPatience; then plays the move with /move and
+// persists it. progress stays in botThinking until it returns.
+func retryBotReply(db *sql.DB, gameID int, fen string, bot botSearch, progress *BotProgress, retryAfter int) {
+	defer botThinking.CompareAndDelete(gameID, progress)
+	giveUp := time.Now().Add(botReplyPatience)
+	for {
+		time.Sleep(time.Duration(max(retryAfter, 1)) * time.Second)
+		var err error
+		retryAfter, err = playBotReply(db, gameID, fen, bot, progress)
+		if err == nil || err == errStaleMove || time.Now().After(giveUp) {
+			return
+		}
+		if retryAfter == 0 {
+			retryAfter = 5
+		}
 	}
+}
 
-	tx, err := db.Begin()
-	if err != nil {
-		return
+// playBotReply searches the bot's move with /search-stream, plays it with /move
+// and persists it. A busy lane returns its Retry-After along with the error.
+func playBotReply(db *sql.DB, gameID int, fen string, bot botSearch, progress *BotProgress) (int, error) {
+	payload := map[string]any{"fen": fen, "depth": bot.Depth, "noise": bot.Noise}
+	if bot.TimeMs > 0 {
+		payload["time_ms"] = bot.TimeMs
 	}
-	defer tx.Rollback() //nolint:errcheck
+	searchPayload, _ := json.Marshal(payload)
+	searchClient := &http.Client{Timeout: 120 * time.Second}
 
-	var ply int
-	if err = tx.QueryRow(`SELECT COUNT(*) + 1 FROM moves WHERE game_id = $1`, gameID).Scan(&ply); err != nil {
-		return
+	globalMetrics.engineBegin()
+	resp, err := doEngineForGame(searchClient, gameID, func(base string) *http.Request {
+		req, _ := http.NewRequest(http.MethodPost, base+"/search-stream", bytes.NewReader(searchPayload))
+		req.Header.Set("Content-Type", "application/json")
+		req.Header.Set("X-Search-Priority", "bot")
+		setEngineDeadline(req, searchClient.Timeout)
+		return req
+	})
+	if err != nil {
+		globalMetrics.engineEnd()
+		return 0, err
 	}
-	if _, err = tx.Exec(`UPDATE games SET current_fen = $1, status = $2 WHERE id = $3`, engineResp.NewFEN, newStatus, gameID); err != nil {
-		return
+	var ev turnEvent
+	if engineBusy(resp) {
+		retryAfter, _ := strconv.Atoi(resp.Header.Get("Retry-After"))
+		err = errors.New("engine busy")
+		resp.Body.Close()
+		globalMetrics.engineEnd()
+		return max(retryAfter, 1), err
 	}
-	if _, err = tx.Exec(`INSERT INTO moves (game_id, ply, uci, fen_after) VALUES ($1, $2, $3, $4)`, gameID, ply, bestMove, engineResp.NewFEN); err != nil {
-		return
+	if resp.StatusCode == http.StatusOK {
+		scanner := bufio.NewScanner(resp.Body)
+		for nextTurnEvent(scanner, &ev) {
+			progress.update(ev)
+			if ev.Done {
+				break
+			}
+		}
+	}
+	resp.Body.Close()
+	globalMetrics.engineEnd()
+	if !ev.Done || ev.BestMove == "" {
+		return 0, errors.New("no bot move")
 	}
-	_ = tx.Commit()
+
+	movePayload, _ := json.Marshal(map[string]string{"fen": fen, "uci_move": ev.BestMove})
+	resp, err = doEngineForGame(engineClient, gameID, func(base string) *http.Request {
+		req, _ := http.NewRequest(http.MethodPost, base+"/move", bytes.NewReader(movePayload))
+		req.Header.Set("Content-Type", "application/json")
+		setEngineDeadline(req, engineClient.Timeout)
+		return req
+	})
+	if err != nil {
+		return 0, err
+	}
+	defer resp.Body.Close()
+	var played turnEvent
+	if json.NewDecoder(resp.Body).Decode(&played) != nil || played.Status != "VALID" {
+		return 0, errors.New("bot move rejected")
+	}
+	return 0, recordMove(db, gameID, ev.BestMove, fen, played.NewFEN, gameStatus(played.GameState))
 }
 
 // hintStreamHandler streams SSE events from the engine as each search depth
@@ -609,9 +786,18 @@ func hintStreamHandler(db *sql.DB) http.HandlerFunc {
 			"depth":   64,
 			"time_ms": 5000,
 		})
+		// Hints queue behind bot replies in the engine's search lane.
+		// Bound to the browser's request, so leaving the page ends the engine call.
+		// Same replica as the game's moves, whose TT already holds this position.
 		searchClient := &http.Client{Timeout: 120 * time.Second}
 		globalMetrics.engineBegin()
-		resp, err := searchClient.Post(engineURL()+"/search-stream", "application/json", bytes.NewReader(payload))
+		resp, err := doEngineForGame(searchClient, id, func(base string) *http.Request {
+			req, _ := http.NewRequestWithContext(r.Context(), http.MethodPost, base+"/search-stream", bytes.NewReader(payload))
+			req.Header.Set("Content-Type", "application/json")
+			req.Header.Set("X-Search-Priority", "hint")
+			setEngineDeadline(req, searchClient.Timeout)
+			return req
+		})
 		if err != nil {
 			globalMetrics.engineEnd()
 			// Already sent SSE headers, so write error as SSE event.
@@ -624,6 +810,13 @@ func hintStreamHandler(db *sql.DB) http.HandlerFunc {
 			globalMetrics.engineEnd()
 		}()
 
+		if engineBusy(resp) {
+			// No hint is spent; the client may retry after the given delay.
+			retryAfter, _ := strconv.Atoi(resp.Header.Get("Retry-After"))
+			fmt.Fprintf(w, "data: {\"error\":\"engine busy\",\"retry_after\":%d}\n\n", retryAfter)
+			flusher.Flush()
+			return
+		}
 		if resp.StatusCode != http.StatusOK {
 			fmt.Fprintf(w, "data: {\"error\":\"engine error\"}\n\n")
 			flusher.Flush()
@@ -0,0 +1,157 @@
+#include "Affinity.h"
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "Search.h"
+
+namespace {
+
+// From <linux/mempolicy.h>, which not every build image ships.
+constexpr int MPOL_BIND_MODE = 2;
+constexpr int MPOL_INTERLEAVE_MODE = 3;
+constexpr unsigned MPOL_MF_MOVE_FLAG = 1 << 1;
+constexpr int MAX_NODES = 1024;
+
+cpu_set_t g_process_mask;
+bool g_have_mask = false;
+NumaTopology g_topology;
+
+// Parses a sysfs CPU list such as "0-3,8-11".
+std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) continue;
+        size_t dash = range.find('-');
+        int lo = std::atoi(range.c_str());
+        int hi = dash == std::string::npos ? lo : std::atoi(range.c_str() + dash + 1);
+        for (int cpu = lo; cpu <= hi; cpu++) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+bool allowed(int cpu) {
+    return !g_have_mask || (cpu >= 0 && cpu < CPU_SETSIZE && CPU_ISSET(cpu, &g_process_mask));
+}
+
+NumaTopology read_topology() {
+    NumaTopology topology;
+    if (DIR* dir = opendir("/sys/devices/system/node")) {
+        std::vector<int> nodes;
+        while (dirent* entry = readdir(dir)) {
+            if (std::strncmp(entry->d_name, "node", 4) == 0 && std::isdigit(entry->d_name[4])) {
+                nodes.push_back(std::atoi(entry->d_name + 4));
+            }
+        }
+        closedir(dir);
+        std::sort(nodes.begin(), nodes.end());
+        for (int node : nodes) {
+            std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            std::string list;
+            std::getline(in, list);
+            std::vector<int> cpus;
+            for (int cpu : parse_cpu_list(list)) {
+                if (allowed(cpu)) cpus.push_back(cpu);
+            }
+            if (!cpus.empty()) topology.node_cpus.push_back(std::move(cpus));
+        }
+    }
+    if (topology.node_cpus.empty()) {
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (g_have_mask ? CPU_ISSET(cpu, &g_process_mask) : cpu < static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN))) {
+                cpus.push_back(cpu);
+            }
+        }
+        topology.node_cpus.push_back(std::move(cpus));
+    }
+    return topology;
+}
+
+long mbind_range(void* start, size_t bytes, int mode, const unsigned long* nodemask) {
+    // mbind wants a page-aligned start; shrink the range inward to whole pages.
+    uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t begin = (reinterpret_cast<uintptr_t>(start) + page - 1) & ~(page - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(start) + bytes) & ~(page - 1);
+    if (end <= begin) return 0;
+    return syscall(SYS_mbind, begin, end - begin, mode, nodemask, MAX_NODES + 1, MPOL_MF_MOVE_FLAG);
+}
+
+} // namespace
+
+void init_placement() {
+    g_have_mask = sched_getaffinity(0, sizeof(g_process_mask), &g_process_mask) == 0;
+    g_topology = read_topology();
+}
+
+const NumaTopology& numa_topology() {
+    return g_topology;
+}
+
+std::vector<int> placement_cpus() {
+    std::vector<int> cpus;
+    for (const auto& node : g_topology.node_cpus) cpus.insert(cpus.end(), node.begin(), node.end());
+    return cpus;
+}
+
+bool pin_thread_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+void unpin_thread() {
+    if (g_have_mask) pthread_setaffinity_np(pthread_self(), sizeof(g_process_mask), &g_process_mask);
+}
+
+bool place_tt_memory(const std::string& policy, std::string& error) {
+    unsigned long nodemask[MAX_NODES / (8 * sizeof(unsigned long))] = {};
+    int mode;
+    if (policy == "interleave") {
+        // Every node the kernel knows; the policy skips nodes without memory.
+        DIR* dir = opendir("/sys/devices/system/node");
+        if (!dir) {
+            error = "no NUMA topology";
+            return false;
+        }
+        while (dirent* entry = readdir(dir)) {
+            if (std::strncmp(entry->d_name, "node", 4) != 0 || !std::isdigit(entry->d_name[4])) continue;
+            int node = std::atoi(entry->d_name + 4);
+            if (node < MAX_NODES) nodemask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+        }
+        closedir(dir);
+        mode = MPOL_INTERLEAVE_MODE;
+    } else if (policy.rfind("node:", 0) == 0) {
+        int node = std::atoi(policy.c_str() + 5);
+        if (node < 0 || node >= MAX_NODES) {
+            error = "node out of range";
+            return false;
+        }
+        nodemask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+        mode = MPOL_BIND_MODE;
+    } else {
+        error = "unknown policy \"" + policy + "\" (interleave or node:N)";
+        return false;
+    }
+
+    TTInfo tt = tt_info();
+    if (mbind_range(tt.memory, tt.entries * sizeof(TTEntry), mode, nodemask) != 0) {
+        error = std::string("mbind failed: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// ============= CPU and NUMA Placement =============
+//
+// On multi-socket hosts a search thread that migrates between sockets loses its
+// caches and reaches the TT across the interconnect, so nodes per second vary
+// from one search to the next. Two optional controls:
+//
+//   - Pinning: the search scheduler's core k runs on placement_cpus()[k], the
+//     process's allowed CPUs ordered node by node, so scheduled searches fill
+//     one socket before spilling onto the next. A thread is pinned while it holds
+//     a core and gets the process's full mask back when its search ends, so HTTP
+//     workers that also searched aren't stuck on one CPU afterwards.
+//   - TT placement: "interleave" spreads the table's pages round-robin over the
+//     nodes (even bandwidth, the same average latency for every search), and
+//     "node:N" binds them to node N (for a replica pinned to that socket). It
+//     must run before searches fault the pages in; pages already touched are
+//     migrated.
+//
+// Topology comes from /sys/devices/system/node; without it the host counts as
+// one node. Memory policy uses the raw mbind syscall, so no libnuma is needed.
+
+struct NumaTopology {
+    std::vector<std::vector<int>> node_cpus; // allowed CPUs of each node with any
+};
+
+// Captures the process's CPU mask (restored by unpin_thread) and the topology.
+// Call once at startup, before pinning anything.
+void init_placement();
+
+const NumaTopology& numa_topology();
+
+// Allowed CPUs, node by node, in ascending order within a node.
+std::vector<int> placement_cpus();
+
+bool pin_thread_to_cpu(int cpu);
+void unpin_thread();
+
+// Applies policy ("interleave" or "node:N") to the TT's memory. Returns false
+// with a reason if the policy is unknown or the kernel refused it.
+bool place_tt_memory(const std::string& policy, std::string& error);
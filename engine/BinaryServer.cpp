@@ -0,0 +1,541 @@
+#include "BinaryServer.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Board.h"
+#include "Deadline.h"
+#include "Metrics.h"
+#include "Move.h"
+#include "Search.h"
+#include "SearchLane.h"
+#include "Validator.h"
+
+namespace {
+
+// ============= Little-endian Codec =============
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : p_(data), end_(data + size) {}
+
+    bool good() const { return ok_; }
+    bool at_end() const { return p_ == end_; }
+
+    uint8_t u8() {
+        if (!need(1)) return 0;
+        return *p_++;
+    }
+
+    uint16_t u16() {
+        if (!need(2)) return 0;
+        uint16_t v = static_cast<uint16_t>(p_[0] | (p_[1] << 8));
+        p_ += 2;
+        return v;
+    }
+
+    uint32_t u32() {
+        if (!need(4)) return 0;
+        uint32_t v = static_cast<uint32_t>(p_[0]) | (static_cast<uint32_t>(p_[1]) << 8)
+                   | (static_cast<uint32_t>(p_[2]) << 16) | (static_cast<uint32_t>(p_[3]) << 24);
+        p_ += 4;
+        return v;
+    }
+
+    bool bytes(void* out, size_t n) {
+        if (!need(n)) return false;
+        std::memcpy(out, p_, n);
+        p_ += n;
+        return true;
+    }
+
+    std::string_view view(size_t n) {
+        if (!need(n)) return {};
+        std::string_view v(reinterpret_cast<const char*>(p_), n);
+        p_ += n;
+        return v;
+    }
+
+private:
+    bool need(size_t n) {
+        if (!ok_ || static_cast<size_t>(end_ - p_) < n) {
+            ok_ = false;
+            return false;
+        }
+        return true;
+    }
+
+    const uint8_t* p_;
+    const uint8_t* end_;
+    bool ok_ = true;
+};
+
+class Writer {
+public:
+    explicit Writer(std::vector<uint8_t>& out) : out_(out) {}
+
+    void u8(uint8_t v) { out_.push_back(v); }
+    void u16(uint16_t v) {
+        out_.push_back(static_cast<uint8_t>(v));
+        out_.push_back(static_cast<uint8_t>(v >> 8));
+    }
+    void u32(uint32_t v) {
+        for (int i = 0; i < 4; i++) out_.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+    void bytes(const void* data, size_t n) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        out_.insert(out_.end(), p, p + n);
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+};
+
+// ============= Connections =============
+
+struct Connection {
+    explicit Connection(int fd) : fd(fd) {}
+    ~Connection() { ::close(fd); }
+
+    int fd;
+    std::atomic<bool> open{true};
+    std::mutex write_mu;
+
+    // Searches running for this connection, keyed by request_id, so CANCEL frames
+    // and disconnects can stop them.
+    std::mutex searches_mu;
+    std::unordered_map<uint32_t, std::shared_ptr<std::atomic<bool>>> searches;
+};
+
+bool write_all(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool read_all(int fd, uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::recv(fd, data, size, 0);
+        if (n == 0) return false;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Frames are assembled in one buffer and written under the connection's lock so
+// frames from concurrent searches never interleave mid-frame.
+bool send_frame(Connection& conn, FrameType type, uint32_t request_id,
+                const std::vector<uint8_t>& payload) {
+    if (!conn.open.load()) return false;
+
+    std::vector<uint8_t> frame;
+    frame.reserve(FRAME_HEADER_SIZE + payload.size());
+    Writer w(frame);
+    w.u32(static_cast<uint32_t>(payload.size()));
+    w.u32(request_id);
+    w.u8(static_cast<uint8_t>(type));
+    w.u8(0);
+    w.u16(0);
+    w.bytes(payload.data(), payload.size());
+
+    std::lock_guard lock(conn.write_mu);
+    if (!write_all(conn.fd, frame.data(), frame.size())) {
+        conn.open.store(false);
+        return false;
+    }
+    return true;
+}
+
+void send_error(Connection& conn, uint32_t request_id, ProtocolError code, std::string_view message) {
+    std::vector<uint8_t> payload;
+    Writer w(payload);
+    w.u16(static_cast<uint16_t>(code));
+    w.bytes(message.data(), message.size());
+    send_frame(conn, FrameType::ERROR, request_id, payload);
+}
+
+// ============= Positions and Moves =============
+
+// Decodes a position field into a freshly constructed board.
+bool read_position(Reader& r, Board& board, PositionEncoding& encoding) {
+    encoding = static_cast<PositionEncoding>(r.u8());
+    if (!r.good()) return false;
+
+    if (encoding == POSITION_PACKED) {
+        PackedPosition pos;
+        r.bytes(pos.squares, sizeof(pos.squares));
+        pos.side = r.u8();
+        pos.castling = r.u8();
+        pos.ep_square = r.u8();
+        pos.halfmove_clock = r.u8();
+        pos.fullmove_number = r.u16();
+        return r.good() && board.setup_with_packed(pos);
+    }
+
+    if (encoding == POSITION_FEN) {
+        uint8_t length = r.u8();
+        std::string_view fen = r.view(length);
+        if (!r.good()) return false;
+        try {
+            board.setup_with_fen(std::string(fen));
+        } catch (...) {
+            return false;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void write_position(Writer& w, Board& board, PositionEncoding encoding) {
+    w.u8(encoding);
+    if (encoding == POSITION_PACKED) {
+        PackedPosition pos = board.pack();
+        w.bytes(pos.squares, sizeof(pos.squares));
+        w.u8(pos.side);
+        w.u8(pos.castling);
+        w.u8(pos.ep_square);
+        w.u8(pos.halfmove_clock);
+        w.u16(pos.fullmove_number);
+    } else {
+        char fen[FEN_MAX_LENGTH];
+        size_t length = board.write_fen(fen);
+        w.u8(static_cast<uint8_t>(length));
+        w.bytes(fen, length);
+    }
+}
+
+int promotion_code(Move m) {
+    switch (m.flags()) {
+        case PR_KNIGHT: case PC_KNIGHT: return 1;
+        case PR_BISHOP: case PC_BISHOP: return 2;
+        case PR_ROOK:   case PC_ROOK:   return 3;
+        case PR_QUEEN:  case PC_QUEEN:  return 4;
+        default:                        return 0;
+    }
+}
+
+uint16_t to_wire(Move m) {
+    return static_cast<uint16_t>(m.from() | (m.to() << 6) | (promotion_code(m) << 12));
+}
+
+// Encodes a UCI string ("e7e8q") directly, for moves reported by the search.
+uint16_t uci_to_wire(std::string_view uci) {
+    if (uci.size() < 4) return 0;
+    int from = (uci[0] - 'a') + 8 * (uci[1] - '1');
+    int to   = (uci[2] - 'a') + 8 * (uci[3] - '1');
+    int promotion = 0;
+    if (uci.size() > 4) {
+        switch (uci[4]) {
+            case 'n': promotion = 1; break;
+            case 'b': promotion = 2; break;
+            case 'r': promotion = 3; break;
+            case 'q': promotion = 4; break;
+        }
+    }
+    return static_cast<uint16_t>(from | (to << 6) | (promotion << 12));
+}
+
+// Returns the legal move matching the wire encoding, or a null Move if there is none.
+Move from_wire(Board& board, uint16_t wire) {
+    Move moves[256];
+    int count = board.get_legal_moves(moves);
+    for (int i = 0; i < count; i++) {
+        if (to_wire(moves[i]) == wire) return moves[i];
+    }
+    return Move();
+}
+
+void write_search_frame(Writer& w, int depth, uint8_t flags, uint16_t best, int score, int nodes) {
+    w.u8(static_cast<uint8_t>(depth));
+    w.u8(flags);
+    w.u16(best);
+    w.u32(static_cast<uint32_t>(score));
+    w.u32(static_cast<uint32_t>(nodes));
+}
+
+// ============= Request Handlers =============
+
+void handle_move(Connection& conn, uint32_t request_id, Reader& r) {
+    Board board;
+    PositionEncoding encoding;
+    if (!read_position(r, board, encoding)) {
+        send_error(conn, request_id, ProtocolError::BAD_POSITION, "failed to parse position");
+        return;
+    }
+    uint16_t wire = r.u16();
+    if (!r.good()) {
+        send_error(conn, request_id, ProtocolError::BAD_FRAME, "truncated move request");
+        return;
+    }
+
+    std::vector<uint8_t> payload;
+    Writer w(payload);
+    Move m = from_wire(board, wire);
+    if (m == Move()) {
+        w.u8(0);
+        w.u8(0);
+    } else {
+        board.move(m);
+        w.u8(1);
+        w.u8(static_cast<uint8_t>(classify_game_state(board)));
+        write_position(w, board, encoding);
+    }
+    send_frame(conn, FrameType::MOVE_RESULT, request_id, payload);
+}
+
+void handle_search(const std::shared_ptr<Connection>& conn, uint32_t request_id, Reader& r) {
+    auto arrived = std::chrono::steady_clock::now();
+    Board board;
+    PositionEncoding encoding;
+    if (!read_position(r, board, encoding)) {
+        send_error(*conn, request_id, ProtocolError::BAD_POSITION, "failed to parse position");
+        return;
+    }
+    int depth   = r.u8();
+    uint8_t flags = r.u8();
+    int noise   = r.u16();
+    int time_ms = static_cast<int>(r.u32());
+    if (!r.good()) {
+        send_error(*conn, request_id, ProtocolError::BAD_FRAME, "truncated search request");
+        return;
+    }
+    // Older clients end the frame at time_ms.
+    Deadline deadline;
+    if (!r.at_end()) {
+        deadline = Deadline::from_ms(r.u32(), arrived);
+        if (!r.good()) {
+            send_error(*conn, request_id, ProtocolError::BAD_FRAME, "truncated search request");
+            return;
+        }
+        if (deadline.expired()) {
+            send_error(*conn, request_id, ProtocolError::DEADLINE_EXCEEDED, "deadline exceeded");
+            return;
+        }
+    }
+    if (depth < 1 || depth > 64) {
+        send_error(*conn, request_id, ProtocolError::BAD_DEPTH, "depth must be 1-64");
+        return;
+    }
+
+    // Opening book: answer inline.
+    std::string book_move = book_lookup(board.to_fen());
+    if (!book_move.empty()) {
+        std::vector<uint8_t> payload;
+        Writer w(payload);
+        write_search_frame(w, 0, RESULT_BOOK, uci_to_wire(book_move), 0, 0);
+        send_frame(*conn, FrameType::SEARCH_RESULT, request_id, payload);
+        return;
+    }
+
+    // The reader thread must never block, so binary searches don't queue: they
+    // run now or are refused.
+    std::shared_ptr<SearchLane::Permit> permit;
+    if (!search_lane().try_acquire(permit)) {
+        send_error(*conn, request_id, ProtocolError::BUSY, "search lane full");
+        return;
+    }
+
+    // A second search under a running id would take over its CANCEL target.
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    bool added;
+    {
+        std::lock_guard lock(conn->searches_mu);
+        added = conn->searches.emplace(request_id, cancelled).second;
+    }
+    if (!added) {
+        send_error(*conn, request_id, ProtocolError::DUPLICATE_ID, "id already running");
+        return;
+    }
+
+    // Boards don't copy (UndoInfo's copy constructor only keeps `entry`), so the
+    // search thread rebuilds the position from its packed form.
+    PackedPosition pos = board.pack();
+    std::thread([conn, request_id, pos, depth, flags, noise, time_ms, deadline, cancelled, permit] {
+        Board search_board;
+        search_board.setup_with_packed(pos);
+
+        DepthCallback cb = [&](int d, const std::string& best_move, int score, int nodes) -> bool {
+            if (cancelled->load() || !conn->open.load()) return false;
+            if (flags & SEARCH_STREAM) {
+                std::vector<uint8_t> payload;
+                Writer w(payload);
+                write_search_frame(w, d, 0, uci_to_wire(best_move), score, nodes);
+                return send_frame(*conn, FrameType::SEARCH_PROGRESS, request_id, payload);
+            }
+            return true;
+        };
+
+        SearchLimits limits;
+        limits.depth = depth;
+        limits.noise = noise;
+        limits.time_ms = time_ms;
+        limits.cancel = cancelled.get();
+        deadline.clamp(limits);
+
+        g_searches_in_flight.fetch_add(1);
+        SearchResult result = search(search_board, limits, cb);
+        g_searches_in_flight.fetch_sub(1);
+
+        {
+            std::lock_guard lock(conn->searches_mu);
+            conn->searches.erase(request_id);
+        }
+
+        std::vector<uint8_t> payload;
+        Writer w(payload);
+        write_search_frame(w, result.depth_completed, 0, to_wire(result.best_move), result.score, result.nodes);
+        send_frame(*conn, FrameType::SEARCH_RESULT, request_id, payload);
+    }).detach();
+}
+
+void handle_cancel(Connection& conn, uint32_t request_id) {
+    std::lock_guard lock(conn.searches_mu);
+    auto it = conn.searches.find(request_id);
+    if (it != conn.searches.end()) it->second->store(true);
+}
+
+void serve_connection(std::shared_ptr<Connection> conn) {
+    std::vector<uint8_t> payload;
+    while (true) {
+        uint8_t header[FRAME_HEADER_SIZE];
+        if (!read_all(conn->fd, header, sizeof(header))) break;
+
+        Reader h(header, sizeof(header));
+        uint32_t length     = h.u32();
+        uint32_t request_id = h.u32();
+        auto type           = static_cast<FrameType>(h.u8());
+
+        if (length > MAX_FRAME_PAYLOAD) {
+            send_error(*conn, request_id, ProtocolError::BAD_FRAME, "frame too large");
+            break;
+        }
+        payload.resize(length);
+        if (!read_all(conn->fd, payload.data(), length)) break;
+
+        Reader r(payload.data(), payload.size());
+        switch (type) {
+            case FrameType::MOVE_REQUEST:   handle_move(*conn, request_id, r); break;
+            case FrameType::SEARCH_REQUEST: handle_search(conn, request_id, r); break;
+            case FrameType::CANCEL:         handle_cancel(*conn, request_id); break;
+            case FrameType::PING:           send_frame(*conn, FrameType::PONG, request_id, {}); break;
+            default:
+                send_error(*conn, request_id, ProtocolError::UNKNOWN_TYPE, "unknown frame type");
+                break;
+        }
+    }
+
+    // Peer is gone: stop everything it started. The socket closes once the last
+    // search thread drops its reference.
+    conn->open.store(false);
+    std::lock_guard lock(conn->searches_mu);
+    for (auto& [id, cancelled] : conn->searches) cancelled->store(true);
+}
+
+void accept_loop(int listen_fd, bool tcp) {
+    while (true) {
+        int fd = ::accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            std::cerr << "binary listener: accept failed: " << std::strerror(errno) << "\n";
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        if (tcp) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+        std::thread(serve_connection, std::make_shared<Connection>(fd)).detach();
+    }
+}
+
+int listen_tcp(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, SOMAXCONN) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int listen_unix(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) return -1;
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    ::unlink(path.c_str()); // stale socket from a previous run
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, SOMAXCONN) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    // Owner and group only: a co-located caller running as another user in its
+    // own container gets in through a shared group, not through world access.
+    ::chmod(path.c_str(), 0660);
+    return fd;
+}
+
+} // namespace
+
+bool start_binary_server(const BinaryServerConfig& config) {
+    if (config.tcp_port > 0) {
+        int fd = listen_tcp(config.tcp_port);
+        if (fd < 0) {
+            std::cerr << "binary listener: cannot bind port " << config.tcp_port << ": "
+                      << std::strerror(errno) << "\n";
+            return false;
+        }
+        std::thread(accept_loop, fd, true).detach();
+        std::cout << "Binary protocol listening on 0.0.0.0:" << config.tcp_port << "\n";
+    }
+
+    if (!config.unix_socket.empty()) {
+        int fd = listen_unix(config.unix_socket);
+        if (fd < 0) {
+            std::cerr << "binary listener: cannot bind " << config.unix_socket << ": "
+                      << std::strerror(errno) << "\n";
+            return false;
+        }
+        std::thread(accept_loop, fd, false).detach();
+        std::cout << "Binary protocol listening on " << config.unix_socket << "\n";
+    }
+
+    return true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// ============= Binary Engine Protocol =============
+//
+// A compact alternative to the JSON/HTTP API for co-located callers. Every frame is
+//
+//   u32 payload_length | u32 request_id | u8 type | u8 reserved[3] | payload
+//
+// with all integers little-endian. The request_id is chosen by the client and echoed
+// on every frame answering that request, so one connection can multiplex many
+// requests; search progress frames interleave freely with other responses.
+//
+// Positions are encoded as u8 encoding followed by
+//   0 (POSITION_PACKED): a 38-byte PackedPosition (fullmove_number little-endian)
+//   1 (POSITION_FEN):    u8 length, then that many FEN characters
+// Moves are u16: from | to << 6 | promotion << 12 (0 none, 1 N, 2 B, 3 R, 4 Q).
+
+enum class FrameType : uint8_t {
+    MOVE_REQUEST    = 0x01, // position, u16 move
+    SEARCH_REQUEST  = 0x02, // position, u8 depth, u8 search flags, u16 noise, u32 time_ms,
+                            // then optionally u32 deadline_ms (see Deadline.h)
+    CANCEL          = 0x03, // empty; stops the search started under the same request_id
+    PING            = 0x04, // empty
+
+    MOVE_RESULT     = 0x81, // u8 valid, u8 game state, new position (valid moves only,
+                            // same encoding as the request)
+    SEARCH_PROGRESS = 0x82, // u8 depth, u8 result flags, u16 move, i32 score, u32 nodes
+    SEARCH_RESULT   = 0x83, // same layout as SEARCH_PROGRESS; last frame of a search
+    PONG            = 0x84, // empty
+    ERROR           = 0xFF, // u16 error code, UTF-8 message
+};
+
+enum PositionEncoding : uint8_t {
+    POSITION_PACKED = 0,
+    POSITION_FEN    = 1
+};
+
+enum SearchFlags : uint8_t {
+    SEARCH_STREAM = 1 << 0 // send a SEARCH_PROGRESS frame per completed depth
+};
+
+enum ResultFlags : uint8_t {
+    RESULT_BOOK = 1 << 0 // move came from the opening book
+};
+
+enum class ProtocolError : uint16_t {
+    BAD_FRAME         = 1, // truncated or oversized payload
+    BAD_POSITION      = 2, // position failed to decode or parse
+    BAD_DEPTH         = 3, // depth outside 1-64
+    UNKNOWN_TYPE      = 4,
+    BUSY              = 5, // search lane full; retry later
+    DEADLINE_EXCEEDED = 6, // deadline_ms left no time to search
+    DUPLICATE_ID      = 7  // a search under this request_id is still running
+};
+
+constexpr size_t FRAME_HEADER_SIZE = 12;
+constexpr uint32_t MAX_FRAME_PAYLOAD = 4096;
+
+struct BinaryServerConfig {
+    int tcp_port = 0;          // 0 disables the TCP listener
+    std::string unix_socket;   // empty disables the Unix domain socket listener
+};
+
+// Binds the configured listeners and serves each on a background thread.
+// Returns false if a listener could not be bound.
+bool start_binary_server(const BinaryServerConfig& config);
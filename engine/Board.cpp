@@ -1,7 +1,9 @@
 #include "Board.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstdio>
 
 #include "BitboardUtils.h"
 #include <sstream>
@@ -433,8 +435,69 @@ void Board::setup_with_fen(std::string fen) {
     halfmove_clock = std::stoi(tokens[4]);
     full_move_counter = std::stoi(tokens[5]);
 
-    // Parse en passant (Bug 1 fix: write to history[0] directly)
-    history[0].epsq = (tokens[3] == "-") ? NO_SQUARE : SquareMap.at(tokens[3]);
+    // Parse en passant
+    finish_setup((tokens[3] == "-") ? NO_SQUARE : SquareMap.at(tokens[3]));
+}
+
+bool Board::setup_with_packed(const PackedPosition& pos) {
+    if (pos.side > 1 || pos.castling > 0xf || pos.ep_square > NO_SQUARE) return false;
+
+    int kings[2] = {0, 0};
+    for (int sq = 0; sq < 64; sq++) {
+        uint8_t nibble = (pos.squares[sq / 2] >> ((sq % 2) * 4)) & 0xf;
+        if (nibble == 0) continue;
+
+        uint8_t type_idx = (nibble & 7) - 1;
+        if (type_idx >= PIECE_TYPE_COUNT) return false;
+        Color c = (nibble & 8) ? BLACK : WHITE;
+        if (type_idx == KING) kings[c]++;
+
+        Bitboard bb = BitboardUtil::square_to_bitboard(static_cast<Square>(sq));
+        bitboards[c][type_idx] |= bb;
+        occupancy[c] |= bb;
+        occupancy[BOTH] |= bb;
+        mailbox[sq] = {static_cast<PieceType>(type_idx), c};
+    }
+    if (kings[WHITE] != 1 || kings[BLACK] != 1) return false;
+
+    player_to_move = pos.side ? BLACK : WHITE;
+    castling_rights = {
+        static_cast<bool>(pos.castling & 1), static_cast<bool>(pos.castling & 2),
+        static_cast<bool>(pos.castling & 4), static_cast<bool>(pos.castling & 8)
+    };
+
+    game_ply = 0;
+    halfmove_clock = pos.halfmove_clock;
+    full_move_counter = pos.fullmove_number;
+
+    finish_setup(static_cast<Square>(pos.ep_square));
+    return true;
+}
+
+PackedPosition Board::pack() {
+    PackedPosition pos{};
+    for (int sq = 0; sq < 64; sq++) {
+        Piece p = mailbox[sq];
+        if (p.type == NO_PIECE_TYPE) continue;
+        uint8_t nibble = static_cast<uint8_t>((p.type + 1) | (p.color == BLACK ? 8 : 0));
+        pos.squares[sq / 2] |= static_cast<uint8_t>(nibble << ((sq % 2) * 4));
+    }
+    pos.side = (player_to_move == WHITE) ? 0 : 1;
+    pos.castling = static_cast<uint8_t>(castling_rights.white_king_side
+                                        | (castling_rights.white_queen_side << 1)
+                                        | (castling_rights.black_king_side << 2)
+                                        | (castling_rights.black_queen_side << 3));
+    pos.ep_square = history[game_ply].epsq;
+    pos.halfmove_clock = static_cast<uint8_t>(std::min(halfmove_clock, 255));
+    pos.fullmove_number = full_move_counter;
+    return pos;
+}
+
+// Shared tail of every setup path: seeds history[0] and the zobrist key from the
+// freshly placed pieces and state.
+void Board::finish_setup(Square epsq) {
+    // Bug 1 fix: write en passant to history[0] directly
+    history[0].epsq = epsq;
 
     // Bug 3 fix: save parsed castling rights into history[0] so undo_move restores correctly
     history[0].castling_rights = castling_rights;
@@ -1058,7 +1121,7 @@ int Board::get_halfmove_clock() const {
     return halfmove_clock;
 }
 
-Move Board::parse_uci_move(const std::string& uci) {
+Move Board::parse_uci_move(std::string_view uci) {
     Move moves[256];
     int count = get_legal_moves(moves);
     for (int i = 0; i < count; i++) {
@@ -1121,60 +1184,61 @@ bool Board::is_insufficient_material() {
 }
 
 std::string Board::to_fen() {
-    std::string fen;
+    char buf[FEN_MAX_LENGTH];
+    return std::string(buf, write_fen(buf));
+}
+
+size_t Board::write_fen(char* out) {
+    char* p = out;
 
     // 1. Piece placement (rank 8 down to rank 1)
     for (int rank = 7; rank >= 0; rank--) {
         int empty = 0;
         for (int file = 0; file < 8; file++) {
             int sq = rank * 8 + file;
-            Piece p = mailbox[sq];
-            if (p.type == NO_PIECE_TYPE) {
+            Piece piece = mailbox[sq];
+            if (piece.type == NO_PIECE_TYPE) {
                 empty++;
             } else {
                 if (empty > 0) {
-                    fen += static_cast<char>('0' + empty);
+                    *p++ = static_cast<char>('0' + empty);
                     empty = 0;
                 }
-                fen += (p.color == WHITE) ? whitePiecesString[p.type] : blackPiecesString[p.type];
+                *p++ = (piece.color == WHITE) ? whitePiecesString[piece.type] : blackPiecesString[piece.type];
             }
         }
-        if (empty > 0) fen += static_cast<char>('0' + empty);
-        if (rank > 0) fen += '/';
+        if (empty > 0) *p++ = static_cast<char>('0' + empty);
+        if (rank > 0) *p++ = '/';
     }
 
     // 2. Active color
-    fen += ' ';
-    fen += (player_to_move == WHITE) ? 'w' : 'b';
+    *p++ = ' ';
+    *p++ = (player_to_move == WHITE) ? 'w' : 'b';
 
     // 3. Castling rights
-    fen += ' ';
-    std::string castling;
-    if (castling_rights.white_king_side)  castling += 'K';
-    if (castling_rights.white_queen_side) castling += 'Q';
-    if (castling_rights.black_king_side)  castling += 'k';
-    if (castling_rights.black_queen_side) castling += 'q';
-    fen += castling.empty() ? "-" : castling;
+    *p++ = ' ';
+    char* castling = p;
+    if (castling_rights.white_king_side)  *p++ = 'K';
+    if (castling_rights.white_queen_side) *p++ = 'Q';
+    if (castling_rights.black_king_side)  *p++ = 'k';
+    if (castling_rights.black_queen_side) *p++ = 'q';
+    if (p == castling) *p++ = '-';
 
     // 4. En passant square
-    fen += ' ';
+    *p++ = ' ';
     Square epsq = history[game_ply].epsq;
     if (epsq == NO_SQUARE) {
-        fen += '-';
+        *p++ = '-';
     } else {
-        fen += static_cast<char>('a' + (epsq % 8));
-        fen += static_cast<char>('1' + (epsq / 8));
+        *p++ = static_cast<char>('a' + (epsq % 8));
+        *p++ = static_cast<char>('1' + (epsq / 8));
     }
 
-    // 5. Halfmove clock
-    fen += ' ';
-    fen += std::to_string(halfmove_clock);
-
-    // 6. Full-move counter
-    fen += ' ';
-    fen += std::to_string(full_move_counter);
+    // 5. Halfmove clock, 6. Full-move counter
+    p += std::snprintf(p, out + FEN_MAX_LENGTH - p, " %d %u", halfmove_clock,
+                       static_cast<unsigned>(full_move_counter));
 
-    return fen;
+    return static_cast<size_t>(p - out);
 }
 
 // ============= Display Methods =============
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -44,6 +46,9 @@ enum Direction {
 // Separate constant for occupancy tracking
 constexpr uint8_t BOTH = 2;
 
+// Upper bound on the length of a FEN string produced by write_fen (incl. terminator)
+constexpr size_t FEN_MAX_LENGTH = 128;
+
 // ============= Utility Structures =============
 struct Piece {
     PieceType type;
@@ -58,6 +63,20 @@ struct CastlingRights {
     bool black_queen_side : 1;
 };
 
+// Compact binary position (38 bytes) used by the binary protocol.
+// squares holds one nibble per square, a1 in the low nibble of byte 0:
+// 0 = empty, 1-6 = white P,N,B,R,Q,K, 9-14 = the same pieces for black.
+struct PackedPosition {
+    uint8_t squares[32];
+    uint8_t side;           // 0 = white, 1 = black
+    uint8_t castling;       // bit 0 = K, 1 = Q, 2 = k, 3 = q
+    uint8_t ep_square;      // 0-63, or 64 when there is none
+    uint8_t halfmove_clock;
+    uint16_t fullmove_number;
+};
+
+static_assert(sizeof(PackedPosition) == 38, "PackedPosition should be 38 bytes");
+
 //Stores position information which cannot be recovered on undo-ing a move
 struct UndoInfo {
     Bitboard entry = 0;
@@ -110,6 +129,7 @@ private:
     void put_piece(Square s, Piece p);
     void make_move(Square from, Square to);
     void make_quiet_move(Square from, Square to);
+    void finish_setup(Square epsq);
     int relative_dir(Direction dir);
     Square pop_lsb(Bitboard &bb);
 public:
@@ -122,6 +142,8 @@ public:
     // Setup
     void setup();
     void setup_with_fen(std::string fen);
+    bool setup_with_packed(const PackedPosition& pos); // false if pos is malformed
+    PackedPosition pack();
 
     // Game operations
     void move(Move m);
@@ -144,13 +166,14 @@ public:
     void undo_null_move();
 
     // Move validation
-    Move parse_uci_move(const std::string& uci);
+    Move parse_uci_move(std::string_view uci);
     int get_legal_moves(Move* list);
     int get_legal_captures(Move* list);
     bool is_insufficient_material();
 
     // FEN output
     std::string to_fen();
+    size_t write_fen(char* out); // writes into a FEN_MAX_LENGTH buffer, returns length
 
     // Display
     void print();
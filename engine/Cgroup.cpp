@@ -0,0 +1,135 @@
+#include "Cgroup.h"
+
+#include <sched.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <sstream>
+
+static const std::string CGROUP_ROOT = "/sys/fs/cgroup";
+
+std::string own_cgroup_dir() {
+    // cgroup v2 has a single line "0::/path".
+    std::ifstream in("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("0::", 0) != 0) continue;
+        std::string dir = CGROUP_ROOT + line.substr(3);
+        while (dir.size() > CGROUP_ROOT.size() && dir.back() == '/') dir.pop_back();
+        std::ifstream probe(dir + "/cgroup.controllers");
+        // Inside a container's cgroup namespace the path may not resolve from here.
+        return probe.is_open() ? dir : CGROUP_ROOT;
+    }
+    return "";
+}
+
+// "max 100000" or "<quota> <period>" in microseconds.
+static double read_quota(const std::string& dir) {
+    std::ifstream in(dir + "/cpu.max");
+    std::string quota;
+    long long period = 0;
+    if (!(in >> quota >> period) || quota == "max" || period <= 0) return 0;
+    return std::atoll(quota.c_str()) / static_cast<double>(period);
+}
+
+// Counts a cpuset list such as "0-3,8".
+static int count_cpu_list(const std::string& list) {
+    int count = 0;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || !std::isdigit(static_cast<unsigned char>(range[0]))) continue;
+        size_t dash = range.find('-');
+        int lo = std::atoi(range.c_str());
+        int hi = dash == std::string::npos ? lo : std::atoi(range.c_str() + dash + 1);
+        count += std::max(0, hi - lo + 1);
+    }
+    return count;
+}
+
+CpuLimits read_cpu_limits() {
+    CpuLimits limits;
+    std::string dir = own_cgroup_dir();
+    if (!dir.empty()) {
+        // A quota anywhere up the tree caps this cgroup too.
+        for (std::string d = dir; d.size() >= CGROUP_ROOT.size(); d = d.substr(0, d.rfind('/'))) {
+            double quota = read_quota(d);
+            if (quota > 0 && (limits.quota_cpus == 0 || quota < limits.quota_cpus)) limits.quota_cpus = quota;
+            if (d == CGROUP_ROOT) break;
+        }
+        std::ifstream in(dir + "/cpuset.cpus.effective");
+        std::string list;
+        if (std::getline(in, list)) limits.cpuset_cpus = count_cpu_list(list);
+    }
+
+    // The affinity mask reflects the cpuset too, and also taskset/docker --cpuset-cpus
+    // on hosts where the cpuset file isn't visible.
+    cpu_set_t mask;
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+        int allowed = CPU_COUNT(&mask);
+        limits.cpuset_cpus = limits.cpuset_cpus > 0 ? std::min(limits.cpuset_cpus, allowed) : allowed;
+    }
+    if (limits.cpuset_cpus <= 0) limits.cpuset_cpus = std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+    return limits;
+}
+
+double CpuLimits::effective() const {
+    double cpus = cpuset_cpus;
+    if (quota_cpus > 0) cpus = std::min(cpus, quota_cpus);
+    return std::max(0.1, cpus);
+}
+
+// A byte count, or "max".
+static long long read_bytes(const std::string& path) {
+    std::ifstream in(path);
+    std::string value;
+    if (!(in >> value) || value == "max") return -1;
+    return std::atoll(value.c_str());
+}
+
+// The "some avg10=…" figure of a PSI file.
+static double read_psi_some(const std::string& path) {
+    std::ifstream in(path);
+    std::string kind, avg10;
+    if (!(in >> kind >> avg10) || kind != "some" || avg10.rfind("avg10=", 0) != 0) return -1;
+    return std::atof(avg10.c_str() + 6);
+}
+
+MemoryPressure read_memory_pressure() {
+    MemoryPressure pressure;
+    std::string dir = own_cgroup_dir();
+    if (!dir.empty()) {
+        pressure.current_bytes = read_bytes(dir + "/memory.current");
+        if (pressure.current_bytes >= 0) {
+            std::ifstream stat(dir + "/memory.stat");
+            std::string key;
+            long long value;
+            while (stat >> key >> value) {
+                if (key != "inactive_file") continue;
+                pressure.working_bytes = std::max(0LL, pressure.current_bytes - value);
+                break;
+            }
+        }
+        for (std::string d = dir; d.size() >= CGROUP_ROOT.size(); d = d.substr(0, d.rfind('/'))) {
+            for (const char* file : {"/memory.high", "/memory.max"}) {
+                long long limit = read_bytes(d + file);
+                if (limit > 0 && (pressure.limit_bytes == 0 || limit < pressure.limit_bytes)) pressure.limit_bytes = limit;
+            }
+            if (d == CGROUP_ROOT) break;
+        }
+        std::ifstream events(dir + "/memory.events");
+        std::string name;
+        long long count;
+        while (events >> name >> count) {
+            if (name == "high") pressure.high_events = count;
+            else if (name == "max") pressure.max_events = count;
+            else if (name == "oom_kill") pressure.oom_kills = count;
+        }
+        pressure.some_avg10 = read_psi_some(dir + "/memory.pressure");
+    }
+    return pressure;
+}
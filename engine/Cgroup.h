@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+
+// ── Container resource limits ────────────────────────────────────────────────
+// std::thread::hardware_concurrency() reports the host's cores, not what the
+// container may use. These read the cgroup v2 limits that actually apply: the
+// process's own cgroup (from /proc/self/cgroup) and its ancestors up to the
+// mount root, taking the tightest limit found. Outside a cgroup v2 hierarchy
+// (or where a file is missing) the limit reads as absent.
+
+struct CpuLimits {
+    double quota_cpus = 0; // cpu.max quota / period; 0 = no quota
+    int cpuset_cpus = 0;   // CPUs the process may run on (cpuset, affinity mask)
+
+    // CPUs' worth of time the process can use: the quota if tighter than the
+    // cpuset, at least a tenth of a CPU.
+    double effective() const;
+};
+
+CpuLimits read_cpu_limits();
+
+// Directory of the process's cgroup under /sys/fs/cgroup, or empty without v2.
+std::string own_cgroup_dir();
+
+struct MemoryPressure {
+    long long current_bytes = -1; // memory.current of the process's cgroup; -1 if unknown
+    long long working_bytes = -1; // current_bytes less inactive_file (page cache the
+                                  // kernel can drop at no cost); -1 if unknown
+    long long limit_bytes = 0;    // tightest memory.high or memory.max up the tree; 0 = none
+    double some_avg10 = -1;       // PSI "some" avg10 (% of time stalled on memory); -1 if unknown
+    long long high_events = 0;    // memory.events: throttled over memory.high
+    long long max_events = 0;     //   reclaimed at memory.max
+    long long oom_kills = 0;      //   processes the OOM killer took in this cgroup
+};
+
+// Readings of the process's own cgroup only: without a memory.pressure file PSI
+// reads as unknown, since the host-wide figure counts other tenants' stalls.
+MemoryPressure read_memory_pressure();
@@ -0,0 +1,228 @@
+#include "ChessCoreAPI.h"
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <string>
+#include "Board.h"
+#include "Move.h"
+#include "Search.h"
+#include "Validator.h"
+
+static_assert(sizeof(PackedPosition) == CHESS_PACKED_POSITION_SIZE, "C API packed size out of sync");
+static_assert(FEN_MAX_LENGTH <= CHESS_FEN_MAX, "C API FEN buffer too small");
+static_assert(static_cast<int>(GameState::DRAW_INSUFFICIENT) == CHESS_STATE_DRAW_INSUFFICIENT,
+              "C API game states out of sync");
+
+// Board::history holds 256 plies, and a search adds up to 64 plies of main line
+// plus quiescence and null moves on top of the position's own. Positions re-root
+// after this many moves (as game sessions do) and before every search, so long
+// games can be driven move by move through the API.
+static constexpr int REROOT_PLIES = 128;
+
+struct chess_position {
+    std::unique_ptr<Board> board;
+    int plies = 0; // moves applied since the last setup
+};
+
+struct chess_search {
+    std::atomic<bool> cancel{false};
+};
+
+// setup_with_fen accepts some malformed input silently; every position the API
+// hands out must have exactly one king per side, or move generation breaks.
+static bool has_both_kings(Board& board) {
+    int kings[2] = {0, 0};
+    for (int sq = 0; sq < 64; sq++) {
+        if (board.get_piece_type_on_square(Square(sq)) == KING) {
+            kings[board.get_piece_color_on_square(Square(sq))]++;
+        }
+    }
+    return kings[WHITE] == 1 && kings[BLACK] == 1;
+}
+
+static void reroot(chess_position* pos) {
+    PackedPosition packed = pos->board->pack();
+    auto fresh = std::make_unique<Board>();
+    fresh->setup_with_packed(packed);
+    pos->board = std::move(fresh);
+    pos->plies = 0;
+}
+
+static bool copy_string(const std::string& s, char* out, size_t out_size) {
+    if (s.size() + 1 > out_size) return false;
+    std::memcpy(out, s.c_str(), s.size() + 1);
+    return true;
+}
+
+extern "C" {
+
+int chess_api_version(void) {
+    return CHESS_API_VERSION;
+}
+
+// ============= Positions =============
+
+chess_position* chess_position_new(void) {
+    auto* pos = new chess_position;
+    pos->board = std::make_unique<Board>();
+    pos->board->setup();
+    return pos;
+}
+
+void chess_position_free(chess_position* pos) {
+    delete pos;
+}
+
+chess_status chess_position_set_fen(chess_position* pos, const char* fen) {
+    if (!pos || !fen) return CHESS_ERR_INVALID_ARGUMENT;
+    auto board = std::make_unique<Board>();
+    try {
+        board->setup_with_fen(fen);
+    } catch (...) {
+        return CHESS_ERR_BAD_POSITION;
+    }
+    if (!has_both_kings(*board)) return CHESS_ERR_BAD_POSITION;
+    pos->board = std::move(board);
+    pos->plies = 0;
+    return CHESS_OK;
+}
+
+chess_status chess_position_set_packed(chess_position* pos, const uint8_t packed[CHESS_PACKED_POSITION_SIZE]) {
+    if (!pos || !packed) return CHESS_ERR_INVALID_ARGUMENT;
+    PackedPosition p;
+    std::memcpy(p.squares, packed, sizeof(p.squares));
+    p.side = packed[32];
+    p.castling = packed[33];
+    p.ep_square = packed[34];
+    p.halfmove_clock = packed[35];
+    p.fullmove_number = static_cast<uint16_t>(packed[36] | (packed[37] << 8));
+
+    auto board = std::make_unique<Board>();
+    if (!board->setup_with_packed(p)) return CHESS_ERR_BAD_POSITION;
+    pos->board = std::move(board);
+    pos->plies = 0;
+    return CHESS_OK;
+}
+
+chess_status chess_position_get_fen(chess_position* pos, char* out, size_t out_size) {
+    if (!pos || !out) return CHESS_ERR_INVALID_ARGUMENT;
+    char fen[FEN_MAX_LENGTH];
+    size_t length = pos->board->write_fen(fen);
+    if (length + 1 > out_size) return CHESS_ERR_BUFFER_TOO_SMALL;
+    std::memcpy(out, fen, length);
+    out[length] = '\0';
+    return CHESS_OK;
+}
+
+chess_status chess_position_get_packed(chess_position* pos, uint8_t out[CHESS_PACKED_POSITION_SIZE]) {
+    if (!pos || !out) return CHESS_ERR_INVALID_ARGUMENT;
+    PackedPosition p = pos->board->pack();
+    std::memcpy(out, p.squares, sizeof(p.squares));
+    out[32] = p.side;
+    out[33] = p.castling;
+    out[34] = p.ep_square;
+    out[35] = p.halfmove_clock;
+    out[36] = static_cast<uint8_t>(p.fullmove_number);
+    out[37] = static_cast<uint8_t>(p.fullmove_number >> 8);
+    return CHESS_OK;
+}
+
+chess_status chess_position_apply_move(chess_position* pos, const char* uci_move, chess_game_state* state) {
+    if (!pos || !uci_move) return CHESS_ERR_INVALID_ARGUMENT;
+    Move m = pos->board->parse_uci_move(uci_move);
+    if (m == Move()) return CHESS_ERR_ILLEGAL_MOVE;
+
+    pos->board->move(m);
+    if (++pos->plies >= REROOT_PLIES) reroot(pos);
+
+    if (state) *state = static_cast<chess_game_state>(classify_game_state(*pos->board));
+    return CHESS_OK;
+}
+
+chess_game_state chess_position_game_state(chess_position* pos) {
+    if (!pos) return CHESS_STATE_ACTIVE;
+    return static_cast<chess_game_state>(classify_game_state(*pos->board));
+}
+
+int chess_position_legal_moves(chess_position* pos, char (*out)[CHESS_UCI_MAX], int max) {
+    if (!pos || (max > 0 && !out)) return CHESS_ERR_INVALID_ARGUMENT;
+    Move moves[256];
+    int count = pos->board->get_legal_moves(moves);
+    for (int i = 0; i < count && i < max; i++) {
+        copy_string(moves[i].to_uci(), out[i], CHESS_UCI_MAX);
+    }
+    return count;
+}
+
+chess_status chess_validate_move(const char* fen, const char* uci_move, chess_game_state* state,
+                                 char* new_fen, size_t new_fen_size) {
+    if (!fen || !uci_move) return CHESS_ERR_INVALID_ARGUMENT;
+    // Through the position path, so the FEN gets the same king check.
+    chess_position pos;
+    chess_status status = chess_position_set_fen(&pos, fen);
+    if (status != CHESS_OK) return status;
+    status = chess_position_apply_move(&pos, uci_move, state);
+    if (status != CHESS_OK || !new_fen) return status;
+    return chess_position_get_fen(&pos, new_fen, new_fen_size);
+}
+
+// ============= Search =============
+
+chess_search* chess_search_new(void) {
+    return new chess_search;
+}
+
+void chess_search_free(chess_search* search) {
+    delete search;
+}
+
+void chess_search_cancel(chess_search* search) {
+    if (search) search->cancel.store(true);
+}
+
+void chess_search_reset(chess_search* search) {
+    if (search) search->cancel.store(false);
+}
+
+chess_status chess_search_run(chess_search* handle, chess_position* pos, const chess_search_limits* limits,
+                              chess_progress_fn progress, void* user, chess_search_result* out) {
+    if (!pos || !limits || !out) return CHESS_ERR_INVALID_ARGUMENT;
+    if (limits->depth < 1 || limits->depth > 64) return CHESS_ERR_INVALID_ARGUMENT;
+
+    *out = chess_search_result{};
+
+    if (limits->use_book) {
+        std::string book_move = book_lookup(pos->board->to_fen());
+        if (!book_move.empty()) {
+            copy_string(book_move, out->best_move, sizeof(out->best_move));
+            out->book = 1;
+            return CHESS_OK;
+        }
+    }
+
+    if (pos->plies > 0) reroot(pos);
+
+    SearchLimits search_limits;
+    search_limits.depth = limits->depth;
+    search_limits.noise = limits->noise;
+    search_limits.time_ms = limits->time_ms;
+    if (handle) search_limits.cancel = &handle->cancel;
+
+    DepthCallback cb;
+    if (progress) {
+        cb = [progress, user](int depth, const std::string& best_move, int score, int nodes) -> bool {
+            return progress(user, depth, best_move.c_str(), score, nodes) != 0;
+        };
+    }
+
+    SearchResult result = search(*pos->board, search_limits, cb);
+    if (result.depth_completed > 0) {
+        copy_string(result.best_move.to_uci(), out->best_move, sizeof(out->best_move));
+    }
+    out->score = result.score;
+    out->nodes = result.nodes;
+    out->depth = result.depth_completed;
+    return CHESS_OK;
+}
+
+} // extern "C"
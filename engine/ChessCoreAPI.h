@@ -0,0 +1,136 @@
+#pragma once
+
+/*
+ * Stable C ABI over ChessCore, built as libchesscore.so.
+ *
+ * Lets other runtimes (e.g. Go via cgo) validate moves in-process instead of
+ * calling the engine over HTTP. Compatibility rules: functions are never removed
+ * or changed, enum values keep their numbers, and structs only grow at the end.
+ * CHESS_API_VERSION is bumped whenever something is added.
+ *
+ * Thread safety: a chess_position must not be used from two threads at once
+ * (searching temporarily makes and unmakes moves on it). Distinct positions may
+ * be used concurrently. chess_search_cancel() may be called from any thread.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define CHESS_API __attribute__((visibility("default")))
+#else
+#define CHESS_API
+#endif
+
+#define CHESS_API_VERSION 2
+
+/* Size of a packed position: see PackedPosition in Board.h (fullmove little-endian). */
+#define CHESS_PACKED_POSITION_SIZE 38
+/* Buffer size that always fits a FEN produced by chess_position_get_fen(). */
+#define CHESS_FEN_MAX 128
+/* Buffer size for a UCI move string including the terminator ("e7e8q"). */
+#define CHESS_UCI_MAX 6
+
+typedef enum {
+    CHESS_OK                   = 0,
+    CHESS_ERR_INVALID_ARGUMENT = -1,
+    CHESS_ERR_BAD_POSITION     = -2,
+    CHESS_ERR_ILLEGAL_MOVE     = -3,
+    CHESS_ERR_BUFFER_TOO_SMALL = -4
+} chess_status;
+
+/* Same values and meaning as the engine's game_state strings. */
+typedef enum {
+    CHESS_STATE_ACTIVE            = 0,
+    CHESS_STATE_CHECKMATE         = 1,
+    CHESS_STATE_STALEMATE         = 2,
+    CHESS_STATE_DRAW_50_MOVE      = 3,
+    CHESS_STATE_DRAW_INSUFFICIENT = 4
+} chess_game_state;
+
+typedef struct chess_position chess_position;
+typedef struct chess_search chess_search;
+
+CHESS_API int chess_api_version(void);
+
+/* ---- Positions ---- */
+
+/* New position set to the standard starting position. Free with chess_position_free. */
+CHESS_API chess_position* chess_position_new(void);
+CHESS_API void chess_position_free(chess_position* pos);
+
+/* On failure the position keeps its previous contents. */
+CHESS_API chess_status chess_position_set_fen(chess_position* pos, const char* fen);
+CHESS_API chess_status chess_position_set_packed(chess_position* pos,
+                                                 const uint8_t packed[CHESS_PACKED_POSITION_SIZE]);
+
+CHESS_API chess_status chess_position_get_fen(chess_position* pos, char* out, size_t out_size);
+CHESS_API chess_status chess_position_get_packed(chess_position* pos,
+                                                 uint8_t out[CHESS_PACKED_POSITION_SIZE]);
+
+/* Plays uci_move if it is legal and reports the resulting game state.
+ * Returns CHESS_ERR_ILLEGAL_MOVE (position unchanged) otherwise. */
+CHESS_API chess_status chess_position_apply_move(chess_position* pos, const char* uci_move,
+                                                 chess_game_state* state);
+
+/* Game state of the position as it stands (side to move mated, stalemated, ...). */
+CHESS_API chess_game_state chess_position_game_state(chess_position* pos);
+
+/* Writes up to max legal moves as UCI strings and returns the total number of
+ * legal moves (which may exceed max), or a negative chess_status on error. */
+CHESS_API int chess_position_legal_moves(chess_position* pos, char (*out)[CHESS_UCI_MAX], int max);
+
+/* One-shot equivalent of the engine's POST /move. On CHESS_OK the move was legal,
+ * *state and new_fen describe the position after it. fen is checked as by
+ * chess_position_set_fen, so a board without one king per side is
+ * CHESS_ERR_BAD_POSITION. */
+CHESS_API chess_status chess_validate_move(const char* fen, const char* uci_move,
+                                           chess_game_state* state, char* new_fen,
+                                           size_t new_fen_size);
+
+/* ---- Search ---- */
+
+typedef struct {
+    int depth;    /* 1-64 */
+    int noise;    /* leaf evaluation noise in centipawns, 0 for full strength */
+    int time_ms;  /* 0 = no time limit */
+    int use_book; /* non-zero: answer from the opening book when possible */
+} chess_search_limits;
+
+typedef struct {
+    char best_move[CHESS_UCI_MAX]; /* empty if no depth completed */
+    int score;                     /* centipawns, side to move's perspective */
+    int nodes;
+    int depth;                     /* deepest completed iteration, 0 for book moves */
+    int book;                      /* non-zero if the move came from the opening book */
+} chess_search_result;
+
+/* Called after each completed depth. Return 0 to stop the search. */
+typedef int (*chess_progress_fn)(void* user, int depth, const char* best_move, int score, int nodes);
+
+/* A cancellation handle, created uncancelled. One handle serves one search at a time. */
+CHESS_API chess_search* chess_search_new(void);
+CHESS_API void chess_search_free(chess_search* search);
+
+/* Stops a running chess_search_run() on this handle within a few thousand nodes.
+ * A cancel that lands before the search starts stops it at once; the flag stays
+ * set until chess_search_reset(). */
+CHESS_API void chess_search_cancel(chess_search* search);
+
+/* Clears a handle's cancel flag so it can serve another search. */
+CHESS_API void chess_search_reset(chess_search* search);
+
+/* Runs a blocking search on pos. search may be NULL if cancellation isn't needed;
+ * progress may be NULL. The handle's cancel flag is not cleared on entry. */
+CHESS_API chess_status chess_search_run(chess_search* search, chess_position* pos,
+                                        const chess_search_limits* limits,
+                                        chess_progress_fn progress, void* user,
+                                        chess_search_result* out);
+
+#ifdef __cplusplus
+}
+#endif
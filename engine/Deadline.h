@@ -0,0 +1,71 @@
+#pragma once
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <string_view>
+#include "Search.h"
+
+// ── Caller deadlines ─────────────────────────────────────────────────────────
+// Callers say how many more milliseconds they will wait for an answer
+// (X-Deadline-Ms over HTTP, deadline_ms on /ws and the binary protocol). The
+// value is relative, so caller and replica clocks never need to agree. The engine
+// keeps DEADLINE_MARGIN_MS of it for serialization and the trip back: a request
+// arriving with less is refused before anything is parsed, and searches are
+// clamped to stop inside the budget, so no CPU goes to answers nobody receives.
+
+constexpr int DEADLINE_MARGIN_MS = 50;
+
+// Longer budgets are taken as this one, so the time_point can't overflow.
+constexpr long long DEADLINE_MAX_MS = 24LL * 60 * 60 * 1000;
+
+struct Deadline {
+    bool set = false;
+    std::chrono::steady_clock::time_point at{}; // end of the usable budget, margin taken
+
+    // remaining_ms as the caller stated it, measured from when the request arrived.
+    // Negative values are already expired.
+    static Deadline from_ms(long long remaining_ms,
+                            std::chrono::steady_clock::time_point arrived = std::chrono::steady_clock::now()) {
+        Deadline d;
+        d.set = true;
+        remaining_ms = std::clamp<long long>(remaining_ms, 0, DEADLINE_MAX_MS);
+        d.at = arrived + std::chrono::milliseconds(remaining_ms - DEADLINE_MARGIN_MS);
+        return d;
+    }
+
+    // Header form; empty or malformed means no deadline.
+    static Deadline parse(std::string_view value) {
+        long long ms = 0;
+        auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), ms);
+        if (value.empty() || ec != std::errc() || end != value.data() + value.size()) return {};
+        return from_ms(ms);
+    }
+
+    // Usable milliseconds left counted from `from`; INT_MAX without a deadline.
+    int budget_ms(std::chrono::steady_clock::time_point from = std::chrono::steady_clock::now()) const {
+        if (!set) return INT_MAX;
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(at - from).count();
+        return static_cast<int>(std::clamp<long long>(ms, INT_MIN, INT_MAX));
+    }
+
+    bool expired() const { return set && budget_ms() <= 0; }
+
+    // A time limit (0 = none) capped at the budget left from `from`.
+    int cap_ms(int time_ms, std::chrono::steady_clock::time_point from = std::chrono::steady_clock::now()) const {
+        if (!set) return time_ms;
+        int budget = std::max(1, budget_ms(from));
+        return (time_ms <= 0 || time_ms > budget) ? budget : time_ms;
+    }
+
+    // Caps limits.time_ms so the search stops before the caller gives up. The
+    // node budget needs no separate cap: the clock is checked alongside it.
+    // Returns true if the deadline cut the time, meaning the result may be
+    // shallower than the same limits would give unhurried.
+    bool clamp(SearchLimits& limits) const {
+        int capped = cap_ms(limits.time_ms);
+        bool cut = capped != limits.time_ms;
+        limits.time_ms = capped;
+        return cut;
+    }
+};
@@ -0,0 +1,216 @@
+#include "DistributedTT.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "Search.h"
+
+namespace {
+
+constexpr uint32_t DTT_MAGIC = 0x31545444; // "DTT1" little-endian
+constexpr uint16_t DTT_VERSION = 1;
+constexpr size_t DTT_HEADER_SIZE = 16;
+constexpr size_t DTT_ENTRY_SIZE = 16;
+constexpr auto RESOLVE_INTERVAL = std::chrono::seconds(30);
+constexpr auto RESOLVE_RETRY = std::chrono::seconds(1); // while no peer resolves
+
+struct PendingEntry {
+    uint64_t key;
+    uint64_t data;
+};
+
+DistributedTTConfig g_config;
+int g_fd = -1;
+uint64_t g_sender_id = 0;
+
+std::mutex g_queue_mu;
+std::vector<PendingEntry> g_queue;
+
+std::atomic<int> g_peer_count{0};
+std::atomic<uint64_t> g_published{0};
+std::atomic<uint64_t> g_dropped{0};
+std::atomic<uint64_t> g_sent{0};
+std::atomic<uint64_t> g_received{0};
+std::atomic<uint64_t> g_rejected{0};
+
+void put_u16(uint8_t* p, uint16_t v) { for (int i = 0; i < 2; i++) p[i] = static_cast<uint8_t>(v >> (8 * i)); }
+void put_u32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = static_cast<uint8_t>(v >> (8 * i)); }
+void put_u64(uint8_t* p, uint64_t v) { for (int i = 0; i < 8; i++) p[i] = static_cast<uint8_t>(v >> (8 * i)); }
+
+uint64_t get_le(const uint8_t* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; i--) v = v << 8 | p[i];
+    return v;
+}
+
+// Runs on search threads: append and return.
+void publish(uint64_t key, uint64_t data) {
+    std::lock_guard lock(g_queue_mu);
+    if (g_queue.size() >= g_config.queue_limit) {
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    g_queue.push_back({key, data});
+    g_published.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<sockaddr_storage> resolve_peers() {
+    std::vector<sockaddr_storage> out;
+    for (const std::string& peer : g_config.peers) {
+        size_t colon = peer.rfind(':');
+        if (colon == std::string::npos) continue;
+        std::string host = peer.substr(0, colon);
+        std::string port = peer.substr(colon + 1);
+
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+        addrinfo* res = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0) continue;
+        // A service name resolves to every replica behind it.
+        for (addrinfo* ai = res; ai; ai = ai->ai_next) {
+            sockaddr_storage addr{};
+            std::memcpy(&addr, ai->ai_addr, ai->ai_addrlen);
+            out.push_back(addr);
+        }
+        freeaddrinfo(res);
+    }
+    return out;
+}
+
+void sender_loop() {
+    std::vector<sockaddr_storage> peers;
+    auto resolved_at = std::chrono::steady_clock::time_point{};
+    std::vector<PendingEntry> batch;
+    uint8_t datagram[DTT_HEADER_SIZE + DTT_MAX_BATCH * DTT_ENTRY_SIZE];
+
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(g_config.flush_ms));
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - resolved_at >= (peers.empty() ? RESOLVE_RETRY : RESOLVE_INTERVAL)) {
+            peers = resolve_peers();
+            g_peer_count.store(static_cast<int>(peers.size()));
+            resolved_at = now;
+        }
+
+        batch.clear();
+        {
+            std::lock_guard lock(g_queue_mu);
+            batch.swap(g_queue);
+        }
+        if (batch.empty() || peers.empty()) continue;
+
+        for (size_t start = 0; start < batch.size(); start += DTT_MAX_BATCH) {
+            size_t count = std::min(DTT_MAX_BATCH, batch.size() - start);
+            put_u32(datagram, DTT_MAGIC);
+            put_u16(datagram + 4, DTT_VERSION);
+            put_u16(datagram + 6, static_cast<uint16_t>(count));
+            put_u64(datagram + 8, g_sender_id);
+            for (size_t i = 0; i < count; i++) {
+                uint8_t* p = datagram + DTT_HEADER_SIZE + i * DTT_ENTRY_SIZE;
+                put_u64(p, batch[start + i].key);
+                put_u64(p + 8, batch[start + i].data);
+            }
+            size_t length = DTT_HEADER_SIZE + count * DTT_ENTRY_SIZE;
+            for (const sockaddr_storage& peer : peers) {
+                if (::sendto(g_fd, datagram, length, 0, reinterpret_cast<const sockaddr*>(&peer),
+                             sizeof(sockaddr_in)) == static_cast<ssize_t>(length)) {
+                    g_sent.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+}
+
+void receiver_loop() {
+    uint8_t datagram[DTT_HEADER_SIZE + DTT_MAX_BATCH * DTT_ENTRY_SIZE];
+    while (true) {
+        ssize_t n = ::recv(g_fd, datagram, sizeof(datagram), 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        size_t length = static_cast<size_t>(n);
+        if (length < DTT_HEADER_SIZE || get_le(datagram, 4) != DTT_MAGIC || get_le(datagram + 4, 2) != DTT_VERSION) {
+            g_rejected.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        size_t count = get_le(datagram + 6, 2);
+        if (count > DTT_MAX_BATCH || length != DTT_HEADER_SIZE + count * DTT_ENTRY_SIZE) {
+            g_rejected.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (get_le(datagram + 8, 8) == g_sender_id) continue;
+
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t* p = datagram + DTT_HEADER_SIZE + i * DTT_ENTRY_SIZE;
+            tt_merge(get_le(p, 8), get_le(p + 8, 8));
+        }
+        g_received.fetch_add(count, std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+std::vector<std::string> parse_peer_list(const std::string& list) {
+    std::vector<std::string> peers;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        if (comma == std::string::npos) comma = list.size();
+        std::string peer = list.substr(start, comma - start);
+        peer.erase(0, peer.find_first_not_of(" \t"));
+        peer.erase(peer.find_last_not_of(" \t") + 1);
+        if (!peer.empty()) peers.push_back(peer);
+        start = comma + 1;
+    }
+    return peers;
+}
+
+bool start_distributed_tt(const DistributedTTConfig& config) {
+    if (config.port <= 0) return true;
+    g_config = config;
+
+    g_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (g_fd < 0) return false;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<uint16_t>(config.port));
+    if (::bind(g_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::cerr << "distributed TT: cannot bind UDP port " << config.port << ": "
+                  << std::strerror(errno) << "\n";
+        ::close(g_fd);
+        g_fd = -1;
+        return false;
+    }
+
+    std::random_device rd;
+    g_sender_id = (uint64_t(rd()) << 32) | rd();
+
+    std::thread(receiver_loop).detach();
+    std::thread(sender_loop).detach();
+    tt_set_publisher(config.publish_depth, publish);
+    std::cout << "Distributed TT on UDP port " << config.port << ", " << config.peers.size()
+              << " peer name(s), publishing depth >= " << config.publish_depth << "\n";
+    return true;
+}
+
+DistributedTTStats distributed_tt_stats() {
+    return {g_fd >= 0, g_peer_count.load(), g_published.load(), g_dropped.load(),
+            g_sent.load(), g_received.load(), g_rejected.load()};
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============= Distributed Transposition Table =============
+//
+// Replicas on different hosts search the same popular positions independently.
+// With peers configured, every TT entry a search stores at publish_depth or
+// deeper is also sent to them, and entries they send are merged into the local
+// table (tt_merge: only where they are deeper than what the slot holds). Shallow
+// entries, the vast majority, never leave the replica.
+//
+// Transport is UDP, best effort: searches only append entries to a queue, a
+// sender thread batches them into datagrams every flush_ms, and a full queue or
+// a lost datagram only costs a shared entry. Each datagram is
+//
+//   u32 magic "DTT1" | u16 version | u16 count | u64 sender_id | count x (u64 key, u64 data)
+//
+// little-endian, at most DTT_MAX_BATCH entries, data being the packed TTEntry
+// word. Receivers check only the header, so peers must be trusted (the engine
+// network is internal). sender_id lets a replica drop its own datagrams when a
+// peer name also resolves to itself.
+
+constexpr size_t DTT_MAX_BATCH = 64; // keeps datagrams under 1100 bytes
+
+struct DistributedTTConfig {
+    int port = 0;                    // UDP port to receive on; 0 disables the layer
+    std::vector<std::string> peers;  // host:port; names are re-resolved periodically
+    int publish_depth = 8;           // shallowest entry worth sending
+    int flush_ms = 20;               // longest an entry waits for its batch
+    size_t queue_limit = 8192;       // entries waiting to be sent; more are dropped
+};
+
+// Parses ENGINE_TT_PEERS' comma-separated host:port list.
+std::vector<std::string> parse_peer_list(const std::string& list);
+
+// Binds the receive port, starts the sender and receiver threads and registers
+// the TT publisher. Returns false if the port could not be bound.
+bool start_distributed_tt(const DistributedTTConfig& config);
+
+struct DistributedTTStats {
+    bool enabled = false;
+    int peers = 0;              // addresses currently resolved
+    uint64_t published = 0;     // entries queued by searches
+    uint64_t dropped = 0;       // entries lost to a full queue
+    uint64_t datagrams_sent = 0;
+    uint64_t received = 0;      // entries received from peers
+    uint64_t rejected = 0;      // datagrams with a bad header
+};
+
+DistributedTTStats distributed_tt_stats();
@@ -0,0 +1,840 @@
+#include "EpollServer.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+constexpr size_t MAX_HEADER_BYTES   = 64 * 1024;
+constexpr size_t MAX_BODY_BYTES     = 4 * 1024 * 1024;
+constexpr size_t MAX_PENDING_OUTPUT = 8 * 1024 * 1024; // per connection; beyond it the client is dropped
+constexpr auto IDLE_TIMEOUT         = std::chrono::seconds(120);
+constexpr size_t MAX_WS_MESSAGE     = 1024 * 1024;
+
+constexpr uint8_t WS_CONTINUATION = 0x0;
+constexpr uint8_t WS_TEXT         = 0x1;
+constexpr uint8_t WS_BINARY       = 0x2;
+constexpr uint8_t WS_CLOSE        = 0x8;
+constexpr uint8_t WS_PING         = 0x9;
+constexpr uint8_t WS_PONG         = 0xA;
+
+const char* reason_phrase(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+    }
+    return "";
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+std::string url_decode(std::string_view s, bool plus_as_space) {
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] == '%' && i + 2 < s.size() && hex_value(s[i + 1]) >= 0 && hex_value(s[i + 2]) >= 0) {
+            out += static_cast<char>(hex_value(s[i + 1]) * 16 + hex_value(s[i + 2]));
+            i += 2;
+        } else if (s[i] == '+' && plus_as_space) {
+            out += ' ';
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// SHA-1 of the handshake key, as RFC 6455 requires. Not used for anything else.
+std::array<uint8_t, 20> sha1(std::string_view data) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    auto rotl = [](uint32_t x, int n) { return (x << n) | (x >> (32 - n)); };
+
+    std::string msg(data);
+    uint64_t bit_length = static_cast<uint64_t>(data.size()) * 8;
+    msg += static_cast<char>(0x80);
+    while (msg.size() % 64 != 56) msg += '\0';
+    for (int i = 7; i >= 0; i--) msg += static_cast<char>(bit_length >> (i * 8));
+
+    for (size_t block = 0; block < msg.size(); block += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            const auto* p = reinterpret_cast<const uint8_t*>(msg.data() + block + i * 4);
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+        }
+        for (int i = 16; i < 80; i++) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+            uint32_t t = rotl(a, 5) + f + e + k + w[i];
+            e = d; d = c; c = rotl(b, 30); b = a; a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    std::array<uint8_t, 20> out;
+    for (int i = 0; i < 20; i++) out[i] = static_cast<uint8_t>(h[i / 4] >> (24 - (i % 4) * 8));
+    return out;
+}
+
+std::string base64(const uint8_t* data, size_t size) {
+    static constexpr char TABLE[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t n = uint32_t(data[i]) << 16;
+        if (i + 1 < size) n |= uint32_t(data[i + 1]) << 8;
+        if (i + 2 < size) n |= data[i + 2];
+        out += TABLE[(n >> 18) & 63];
+        out += TABLE[(n >> 12) & 63];
+        out += i + 1 < size ? TABLE[(n >> 6) & 63] : '=';
+        out += i + 2 < size ? TABLE[n & 63] : '=';
+    }
+    return out;
+}
+
+std::string websocket_accept(std::string_view key) {
+    auto digest = sha1(std::string(key) + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
+    return base64(digest.data(), digest.size());
+}
+
+// Parses the request line and headers (everything before the blank line).
+bool parse_head(std::string_view head, httplib::Request& req) {
+    size_t line_end = head.find("\r\n");
+    std::string_view line = head.substr(0, line_end);
+
+    size_t sp1 = line.find(' ');
+    size_t sp2 = line.rfind(' ');
+    if (sp1 == std::string_view::npos || sp2 == sp1) return false;
+    req.method = std::string(line.substr(0, sp1));
+    req.target = std::string(line.substr(sp1 + 1, sp2 - sp1 - 1));
+    req.version = std::string(line.substr(sp2 + 1));
+    if (req.version != "HTTP/1.1" && req.version != "HTTP/1.0") return false;
+
+    std::string_view target = req.target;
+    size_t q = target.find('?');
+    req.path = url_decode(target.substr(0, q), false);
+    if (q != std::string_view::npos) {
+        std::string_view query = target.substr(q + 1);
+        while (!query.empty()) {
+            size_t amp = query.find('&');
+            std::string_view pair = query.substr(0, amp);
+            size_t eq = pair.find('=');
+            if (!pair.empty()) {
+                req.params.emplace(url_decode(pair.substr(0, eq), true),
+                                   eq == std::string_view::npos ? "" : url_decode(pair.substr(eq + 1), true));
+            }
+            if (amp == std::string_view::npos) break;
+            query.remove_prefix(amp + 1);
+        }
+    }
+
+    while (line_end != std::string_view::npos) {
+        size_t start = line_end + 2;
+        line_end = head.find("\r\n", start);
+        std::string_view header = head.substr(start, line_end == std::string_view::npos ? head.npos : line_end - start);
+        if (header.empty()) continue;
+        size_t colon = header.find(':');
+        if (colon == std::string_view::npos) return false;
+        req.headers.emplace(std::string(trim(header.substr(0, colon))),
+                            std::string(trim(header.substr(colon + 1))));
+    }
+    return true;
+}
+
+} // namespace
+
+struct EpollServer::Connection {
+    explicit Connection(int fd) : fd(fd) {}
+
+    const int fd;
+    std::atomic<bool> closed{false};
+
+    // Event loop thread only.
+    std::string in;
+    bool busy = false;       // a request is being handled; later input waits
+    bool want_write = false; // EPOLLOUT registered
+    std::string remote_addr;
+    int remote_port = 0;
+    std::chrono::steady_clock::time_point last_active = std::chrono::steady_clock::now();
+
+    // Shared between the worker producing a response and the loop writing it.
+    std::mutex out_mu;
+    std::string out;
+    size_t out_offset = 0;
+    bool response_done = false; // the worker has queued the whole response
+    bool close_after = false;   // close once the response has been written
+    bool ws_closing = false;    // a close frame is queued; nothing may follow it
+
+    // WebSocket state after an upgrade (event loop thread only).
+    bool upgraded = false;
+    WebSocketHandlers ws;
+    std::string ws_message; // fragments of the message being received
+    uint8_t ws_opcode = 0;  // opcode of that message, 0 when none is open
+};
+
+// ============= Setup =============
+
+EpollServer::EpollServer(int worker_threads) {
+    for (int i = 0; i < worker_threads; i++) workers_.emplace_back(&EpollServer::worker_main, this);
+}
+
+EpollServer::~EpollServer() {
+    {
+        std::lock_guard lock(tasks_mu_);
+        shutting_down_ = true;
+    }
+    tasks_cv_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+EpollServer& EpollServer::Get(const std::string& pattern, Handler handler) {
+    routes_.push_back({"GET", std::regex(pattern), std::move(handler), {}});
+    return *this;
+}
+
+EpollServer& EpollServer::Post(const std::string& pattern, Handler handler) {
+    routes_.push_back({"POST", std::regex(pattern), std::move(handler), {}});
+    return *this;
+}
+
+EpollServer& EpollServer::Delete(const std::string& pattern, Handler handler) {
+    routes_.push_back({"DELETE", std::regex(pattern), std::move(handler), {}});
+    return *this;
+}
+
+EpollServer& EpollServer::WebSocket(const std::string& pattern, WebSocketOpen open) {
+    routes_.push_back({"GET", std::regex(pattern), nullptr, std::move(open)});
+    return *this;
+}
+
+bool EpollServer::listen(const std::string& host, int port) {
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "epoll server: socket: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    int one = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1 ||
+        ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, SOMAXCONN) < 0) {
+        std::cerr << "epoll server: bind " << host << ":" << port << ": " << std::strerror(errno) << "\n";
+        ::close(listen_fd_);
+        return false;
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+    ev.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+
+    running_.store(true);
+    run_loop();
+
+    for (auto& [fd, conn] : connections_) {
+        conn->closed.store(true);
+        ::close(fd);
+    }
+    connections_.clear();
+    ::close(listen_fd_);
+    ::close(wake_fd_);
+    ::close(epoll_fd_);
+    return true;
+}
+
+void EpollServer::stop() {
+    running_.store(false);
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t n = ::write(wake_fd_, &one, sizeof(one));
+    }
+}
+
+// ============= Event loop =============
+
+void EpollServer::run_loop() {
+    epoll_event events[256];
+    auto last_sweep = std::chrono::steady_clock::now();
+
+    while (running_.load()) {
+        int n = epoll_wait(epoll_fd_, events, 256, 1000);
+        if (n < 0 && errno != EINTR) {
+            std::cerr << "epoll server: epoll_wait: " << std::strerror(errno) << "\n";
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == listen_fd_) {
+                accept_connections();
+                continue;
+            }
+            if (fd == wake_fd_) {
+                uint64_t count;
+                [[maybe_unused]] ssize_t r = ::read(wake_fd_, &count, sizeof(count));
+                std::vector<std::shared_ptr<Connection>> ready;
+                {
+                    std::lock_guard lock(pending_mu_);
+                    ready.swap(pending_);
+                }
+                for (auto& conn : ready) {
+                    if (!conn->closed.load()) flush(conn);
+                }
+                continue;
+            }
+
+            auto it = connections_.find(fd);
+            if (it == connections_.end()) continue;
+            std::shared_ptr<Connection> conn = it->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                close_connection(conn);
+                continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP)) on_readable(conn);
+            if (!conn->closed.load() && (events[i].events & EPOLLOUT)) flush(conn);
+        }
+
+        // Drop keep-alive connections that have gone quiet.
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_sweep >= std::chrono::seconds(1)) {
+            last_sweep = now;
+            std::vector<std::shared_ptr<Connection>> idle;
+            for (auto& [fd, conn] : connections_) {
+                if (!conn->busy && now - conn->last_active > IDLE_TIMEOUT) idle.push_back(conn);
+            }
+            for (auto& conn : idle) close_connection(conn);
+        }
+    }
+}
+
+void EpollServer::accept_connections() {
+    while (true) {
+        sockaddr_in peer{};
+        socklen_t len = sizeof(peer);
+        int fd = accept4(listen_fd_, reinterpret_cast<sockaddr*>(&peer), &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return; // EAGAIN, or out of descriptors until something closes
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        auto conn = std::make_shared<Connection>(fd);
+        char ip[INET_ADDRSTRLEN] = {};
+        inet_ntop(AF_INET, &peer.sin_addr, ip, sizeof(ip));
+        conn->remote_addr = ip;
+        conn->remote_port = ntohs(peer.sin_port);
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            ::close(fd);
+            continue;
+        }
+        connections_[fd] = std::move(conn);
+    }
+}
+
+void EpollServer::on_readable(const std::shared_ptr<Connection>& conn) {
+    char buf[16384];
+    while (true) {
+        ssize_t n = ::recv(conn->fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            conn->in.append(buf, static_cast<size_t>(n));
+            conn->last_active = std::chrono::steady_clock::now();
+            if (conn->in.size() > MAX_HEADER_BYTES + MAX_BODY_BYTES) break;
+            continue;
+        }
+        if (n == 0) {
+            // Peer closed. Also how streaming handlers learn their client has gone.
+            close_connection(conn);
+            return;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        close_connection(conn);
+        return;
+    }
+    if (conn->upgraded) read_frames(conn);
+    else if (!conn->busy) try_dispatch(conn);
+}
+
+// Parses the next complete request from the input buffer and hands it to a worker.
+void EpollServer::try_dispatch(const std::shared_ptr<Connection>& conn) {
+    auto reject = [&](int status) {
+        std::string response = "HTTP/1.1 " + std::to_string(status) + " " + reason_phrase(status) +
+                               "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        conn->busy = true;
+        {
+            std::lock_guard lock(conn->out_mu);
+            conn->out += response;
+            conn->response_done = true;
+            conn->close_after = true;
+        }
+        flush(conn);
+    };
+
+    size_t header_end = conn->in.find("\r\n\r\n");
+    if (header_end == std::string::npos) {
+        if (conn->in.size() > MAX_HEADER_BYTES) reject(431);
+        return;
+    }
+
+    auto req = std::make_shared<httplib::Request>();
+    if (!parse_head(std::string_view(conn->in).substr(0, header_end), *req)) {
+        reject(400);
+        return;
+    }
+    if (req->has_header("Transfer-Encoding")) {
+        reject(501);
+        return;
+    }
+
+    size_t content_length = 0;
+    if (req->has_header("Content-Length")) {
+        std::string value = req->get_header_value("Content-Length");
+        char* end = nullptr;
+        unsigned long long parsed = std::strtoull(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0') {
+            reject(400);
+            return;
+        }
+        if (parsed > MAX_BODY_BYTES) {
+            reject(413);
+            return;
+        }
+        content_length = static_cast<size_t>(parsed);
+    }
+
+    size_t total = header_end + 4 + content_length;
+    if (conn->in.size() < total) return;
+    req->body = conn->in.substr(header_end + 4, content_length);
+    conn->in.erase(0, total);
+
+    std::string connection = req->get_header_value("Connection");
+    bool keep_alive = req->version == "HTTP/1.1" ? !iequals(connection, "close")
+                                                 : iequals(connection, "keep-alive");
+    req->remote_addr = conn->remote_addr;
+    req->remote_port = conn->remote_port;
+
+    conn->busy = true;
+    if (req->method == "GET" && iequals(req->get_header_value("Upgrade"), "websocket")) {
+        upgrade(conn, *req);
+        return;
+    }
+    enqueue([this, conn, req, keep_alive] { handle(conn, *req, keep_alive); });
+}
+
+void EpollServer::flush(const std::shared_ptr<Connection>& conn) {
+    std::unique_lock lock(conn->out_mu);
+    while (conn->out_offset < conn->out.size()) {
+        ssize_t n = ::send(conn->fd, conn->out.data() + conn->out_offset,
+                           conn->out.size() - conn->out_offset, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn->out_offset += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        lock.unlock();
+        close_connection(conn);
+        return;
+    }
+
+    bool drained = conn->out_offset == conn->out.size();
+    if (drained) {
+        conn->out.clear();
+        conn->out_offset = 0;
+    } else if (conn->out_offset > 65536) {
+        conn->out.erase(0, conn->out_offset);
+        conn->out_offset = 0;
+    }
+    bool finished = drained && conn->response_done;
+    bool close_after = conn->close_after;
+    if (finished) {
+        conn->response_done = false;
+        conn->close_after = false;
+    }
+    lock.unlock();
+
+    conn->last_active = std::chrono::steady_clock::now();
+    update_interest(*conn, !drained);
+    if (!finished) return;
+
+    if (close_after) {
+        close_connection(conn);
+        return;
+    }
+    if (conn->upgraded) return;
+    conn->busy = false;
+    try_dispatch(conn);
+}
+
+void EpollServer::close_connection(const std::shared_ptr<Connection>& conn) {
+    if (conn->closed.exchange(true)) return;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn->fd, nullptr);
+    ::close(conn->fd);
+    auto it = connections_.find(conn->fd);
+    if (it != connections_.end() && it->second == conn) connections_.erase(it);
+    if (conn->upgraded && conn->ws.on_close) conn->ws.on_close();
+}
+
+void EpollServer::update_interest(Connection& conn, bool want_write) {
+    if (conn.want_write == want_write || conn.closed.load()) return;
+    conn.want_write = want_write;
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP | (want_write ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    ev.data.fd = conn.fd;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev);
+}
+
+// ============= WebSockets =============
+
+void EpollServer::upgrade(const std::shared_ptr<Connection>& conn, const httplib::Request& req) {
+    auto fail = [&](int status) {
+        std::lock_guard lock(conn->out_mu);
+        conn->out += "HTTP/1.1 " + std::to_string(status) + " " + reason_phrase(status) +
+                     "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        conn->response_done = true;
+        conn->close_after = true;
+    };
+
+    const Route* route = nullptr;
+    httplib::Match matches;
+    for (const Route& r : routes_) {
+        if (r.open && std::regex_match(req.path, matches, r.pattern)) {
+            route = &r;
+            break;
+        }
+    }
+    std::string key = req.get_header_value("Sec-WebSocket-Key");
+    if (!route) fail(404);
+    else if (key.empty() || req.get_header_value("Sec-WebSocket-Version") != "13") fail(400);
+
+    if (!route || conn->close_after) {
+        flush(conn);
+        return;
+    }
+
+    {
+        std::lock_guard lock(conn->out_mu);
+        conn->out += "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                     "Sec-WebSocket-Accept: " + websocket_accept(key) + "\r\n\r\n";
+    }
+    conn->upgraded = true;
+    conn->ws = route->open(req, std::make_shared<WebSocketChannel>(this, conn));
+    flush(conn);
+    if (!conn->closed.load() && !conn->in.empty()) read_frames(conn);
+}
+
+// Decodes every complete frame in the input buffer. Client frames must be masked.
+void EpollServer::read_frames(const std::shared_ptr<Connection>& conn) {
+    auto fail = [&](uint16_t code) {
+        char payload[2] = {static_cast<char>(code >> 8), static_cast<char>(code & 0xff)};
+        queue_frame(*conn, WS_CLOSE, std::string_view(payload, 2), true);
+        conn->in.clear();
+        flush(conn);
+    };
+
+    while (!conn->closed.load()) {
+        const auto* p = reinterpret_cast<const uint8_t*>(conn->in.data());
+        size_t available = conn->in.size();
+        if (available < 2) return;
+
+        bool fin = p[0] & 0x80;
+        uint8_t opcode = p[0] & 0x0f;
+        bool masked = p[1] & 0x80;
+        uint64_t length = p[1] & 0x7f;
+        size_t pos = 2;
+        if (length == 126) {
+            if (available < 4) return;
+            length = (uint64_t(p[2]) << 8) | p[3];
+            pos = 4;
+        } else if (length == 127) {
+            if (available < 10) return;
+            length = 0;
+            for (int i = 0; i < 8; i++) length = (length << 8) | p[2 + i];
+            pos = 10;
+        }
+        if (!masked || (p[0] & 0x70)) return fail(1002);
+        if (length > MAX_WS_MESSAGE || conn->ws_message.size() + length > MAX_WS_MESSAGE) return fail(1009);
+        if (available < pos + 4 + length) return;
+
+        const uint8_t* mask = p + pos;
+        std::string payload(conn->in.data() + pos + 4, static_cast<size_t>(length));
+        for (size_t i = 0; i < payload.size(); i++) payload[i] ^= static_cast<char>(mask[i % 4]);
+        conn->in.erase(0, pos + 4 + static_cast<size_t>(length));
+
+        switch (opcode) {
+            case WS_TEXT:
+            case WS_BINARY:
+                if (conn->ws_opcode != 0) return fail(1002);
+                if (!fin) {
+                    conn->ws_opcode = opcode;
+                    conn->ws_message = std::move(payload);
+                    break;
+                }
+                if (conn->ws.on_message) conn->ws.on_message(payload);
+                break;
+            case WS_CONTINUATION:
+                if (conn->ws_opcode == 0) return fail(1002);
+                conn->ws_message += payload;
+                if (fin) {
+                    std::string message = std::move(conn->ws_message);
+                    conn->ws_message.clear();
+                    conn->ws_opcode = 0;
+                    if (conn->ws.on_message) conn->ws.on_message(message);
+                }
+                break;
+            case WS_PING:
+                queue_frame(*conn, WS_PONG, payload);
+                flush(conn);
+                break;
+            case WS_PONG:
+                break;
+            case WS_CLOSE:
+                // Echo the status code back, then close once it is written.
+                queue_frame(*conn, WS_CLOSE, std::string_view(payload).substr(0, 2), true);
+                conn->in.clear();
+                flush(conn);
+                return;
+            default:
+                return fail(1002);
+        }
+    }
+}
+
+bool EpollServer::queue_frame(Connection& conn, uint8_t opcode, std::string_view payload, bool closing) {
+    if (conn.closed.load()) return false;
+    std::lock_guard lock(conn.out_mu);
+    if (conn.ws_closing) return false;
+    if (opcode < WS_CLOSE && conn.out.size() - conn.out_offset > MAX_PENDING_OUTPUT) return false;
+
+    char header[10];
+    size_t header_size = 2;
+    header[0] = static_cast<char>(0x80 | opcode);
+    if (payload.size() < 126) {
+        header[1] = static_cast<char>(payload.size());
+    } else if (payload.size() <= 0xffff) {
+        header[1] = 126;
+        header[2] = static_cast<char>(payload.size() >> 8);
+        header[3] = static_cast<char>(payload.size() & 0xff);
+        header_size = 4;
+    } else {
+        header[1] = 127;
+        for (int i = 0; i < 8; i++) header[2 + i] = static_cast<char>(uint64_t(payload.size()) >> (56 - i * 8));
+        header_size = 10;
+    }
+    conn.out.append(header, header_size);
+    conn.out += payload;
+    if (closing) {
+        conn.ws_closing = true;
+        conn.response_done = true;
+        conn.close_after = true;
+    }
+    return true;
+}
+
+bool WebSocketChannel::send(std::string_view text) {
+    auto conn = conn_.lock();
+    if (!conn || !server_->queue_frame(*conn, WS_TEXT, text)) return false;
+    server_->wake(conn);
+    return true;
+}
+
+void WebSocketChannel::close() {
+    auto conn = conn_.lock();
+    if (!conn) return;
+    const char normal[2] = {0x03, static_cast<char>(0xe8)}; // 1000
+    if (server_->queue_frame(*conn, WS_CLOSE, std::string_view(normal, 2), true)) server_->wake(conn);
+}
+
+// ============= Workers =============
+
+// Runs the route handler, then queues the response for the event loop. Streaming
+// responses keep this worker only for as long as the content provider runs (for
+// /search-stream, the search itself); the socket writes happen on the loop.
+void EpollServer::handle(const std::shared_ptr<Connection>& conn, httplib::Request& req, bool keep_alive) {
+    httplib::Response res;
+    bool routed = false;
+    for (const Route& route : routes_) {
+        if (!route.handler || route.method != req.method ||
+            !std::regex_match(req.path, req.matches, route.pattern)) continue;
+        routed = true;
+        try {
+            route.handler(req, res);
+        } catch (...) {
+            res = httplib::Response();
+            res.status = 500;
+        }
+        break;
+    }
+    if (!routed) res.status = 404;
+    if (res.status == -1) res.status = 200;
+
+    bool streaming = static_cast<bool>(res.content_provider_);
+    std::string head = "HTTP/1.1 " + std::to_string(res.status) + " " + reason_phrase(res.status) + "\r\n";
+    for (const auto& [name, value] : res.headers) head += name + ": " + value + "\r\n";
+    if (streaming) {
+        head += "Transfer-Encoding: chunked\r\n";
+    } else {
+        head += "Content-Length: " + std::to_string(res.body.size()) + "\r\n";
+    }
+    head += keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+    if (!streaming) {
+        {
+            std::lock_guard lock(conn->out_mu);
+            conn->out += head;
+            conn->out += res.body;
+            conn->response_done = true;
+            conn->close_after = !keep_alive;
+        }
+        wake(conn);
+        return;
+    }
+
+    {
+        std::lock_guard lock(conn->out_mu);
+        conn->out += head;
+    }
+    wake(conn);
+
+    bool done = false;
+    bool overflow = false;
+    auto append = [&](std::string_view data) -> bool {
+        if (conn->closed.load() || overflow) return false;
+        {
+            std::lock_guard lock(conn->out_mu);
+            if (conn->out.size() - conn->out_offset > MAX_PENDING_OUTPUT) {
+                overflow = true;
+                return false;
+            }
+            conn->out += data;
+        }
+        wake(conn);
+        return true;
+    };
+
+    httplib::DataSink sink;
+    sink.write = [&](const char* data, size_t length) -> bool {
+        if (length == 0) return true;
+        char size_line[24];
+        int n = std::snprintf(size_line, sizeof(size_line), "%zx\r\n", length);
+        std::string chunk;
+        chunk.reserve(static_cast<size_t>(n) + length + 2);
+        chunk.append(size_line, static_cast<size_t>(n));
+        chunk.append(data, length);
+        chunk += "\r\n";
+        return append(chunk);
+    };
+    sink.is_writable = [&] { return !conn->closed.load() && !overflow; };
+    auto finish = [&] {
+        if (done) return;
+        done = true;
+        append("0\r\n\r\n");
+    };
+    sink.done = finish;
+    sink.done_with_trailer = [&](const httplib::Headers&) { finish(); };
+
+    // Providers call done() and then return false when they have nothing more.
+    size_t offset = 0;
+    while (!done && sink.is_writable()) {
+        if (!res.content_provider_(offset, 0, sink)) break;
+    }
+    if (res.content_provider_resource_releaser_) res.content_provider_resource_releaser_(done);
+
+    {
+        std::lock_guard lock(conn->out_mu);
+        conn->response_done = true;
+        conn->close_after = !keep_alive || !done || overflow;
+    }
+    wake(conn);
+}
+
+void EpollServer::wake(const std::shared_ptr<Connection>& conn) {
+    {
+        std::lock_guard lock(pending_mu_);
+        pending_.push_back(conn);
+    }
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = ::write(wake_fd_, &one, sizeof(one));
+}
+
+void EpollServer::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard lock(tasks_mu_);
+        tasks_.push_back(std::move(task));
+    }
+    tasks_cv_.notify_one();
+}
+
+void EpollServer::worker_main() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(tasks_mu_);
+            tasks_cv_.wait(lock, [&] { return shutting_down_ || !tasks_.empty(); });
+            if (shutting_down_ && tasks_.empty()) return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
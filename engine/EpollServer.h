@@ -0,0 +1,128 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "httplib.h"
+
+// ── Event-driven HTTP/1.1 server ─────────────────────────────────────────────
+// Drop-in alternative to httplib::Server for the engine's routes: handlers keep
+// the httplib Request/Response signature, so the same route table serves both.
+//
+// One epoll thread owns every socket: it accepts, reads and parses requests, and
+// writes responses, all non-blocking. Only handlers run on the worker pool. An
+// idle keep-alive connection therefore costs a file descriptor, not a thread, and
+// chunked (SSE) output is queued by the worker and drained by the event loop, so
+// a slow consumer never blocks a search thread.
+//
+// Scope: what the engine's callers send. Requests need Content-Length bodies (no
+// chunked uploads), one request is handled at a time per connection (pipelined
+// requests wait in the input buffer), and routes are regexes as in httplib.
+//
+// WebSocket routes (RFC 6455) upgrade a GET into a message channel. Text and
+// binary messages are delivered whole (fragments are joined); ping, pong and
+// close are answered by the loop.
+
+class WebSocketChannel;
+
+// Callbacks for one upgraded connection. Both run on the event loop thread, so
+// they must hand real work elsewhere rather than block.
+struct WebSocketHandlers {
+    std::function<void(std::string_view message)> on_message;
+    std::function<void()> on_close; // once, when the connection is gone for any reason
+};
+
+class EpollServer {
+public:
+    using Handler = std::function<void(const httplib::Request&, httplib::Response&)>;
+    using WebSocketOpen = std::function<WebSocketHandlers(const httplib::Request&, std::shared_ptr<WebSocketChannel>)>;
+
+    explicit EpollServer(int worker_threads);
+    ~EpollServer();
+
+    EpollServer& Get(const std::string& pattern, Handler handler);
+    EpollServer& Post(const std::string& pattern, Handler handler);
+    EpollServer& Delete(const std::string& pattern, Handler handler);
+    EpollServer& WebSocket(const std::string& pattern, WebSocketOpen open);
+
+    // Binds and runs the event loop on the calling thread until stop().
+    bool listen(const std::string& host, int port);
+    void stop();
+
+    struct Connection;
+
+private:
+    friend class WebSocketChannel;
+
+    struct Route {
+        std::string method;
+        std::regex pattern;
+        Handler handler;
+        WebSocketOpen open; // WebSocket routes only
+    };
+
+    void run_loop();
+    void accept_connections();
+    void on_readable(const std::shared_ptr<Connection>& conn);
+    void try_dispatch(const std::shared_ptr<Connection>& conn);
+    void flush(const std::shared_ptr<Connection>& conn);
+    void close_connection(const std::shared_ptr<Connection>& conn);
+    void update_interest(Connection& conn, bool want_write);
+
+    void upgrade(const std::shared_ptr<Connection>& conn, const httplib::Request& req);
+    void read_frames(const std::shared_ptr<Connection>& conn);
+    bool queue_frame(Connection& conn, uint8_t opcode, std::string_view payload, bool closing = false);
+
+    void handle(const std::shared_ptr<Connection>& conn, httplib::Request& req, bool keep_alive);
+    void wake(const std::shared_ptr<Connection>& conn);
+
+    void enqueue(std::function<void()> task);
+    void worker_main();
+
+    std::vector<Route> routes_;
+
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::atomic<bool> running_{false};
+    std::unordered_map<int, std::shared_ptr<Connection>> connections_; // loop thread only
+
+    // Connections with new output or a finished response, handed to the loop.
+    std::mutex pending_mu_;
+    std::vector<std::shared_ptr<Connection>> pending_;
+
+    // Worker pool for handlers.
+    std::mutex tasks_mu_;
+    std::condition_variable tasks_cv_;
+    std::deque<std::function<void()>> tasks_;
+    std::vector<std::thread> workers_;
+    bool shutting_down_ = false;
+};
+
+// Send side of an upgraded connection. Thread-safe: frames are queued and written
+// by the event loop like any other output.
+class WebSocketChannel {
+public:
+    WebSocketChannel(EpollServer* server, std::weak_ptr<EpollServer::Connection> conn)
+        : server_(server), conn_(std::move(conn)) {}
+
+    // Queues a text message. False once the connection is closed or closing, or
+    // when the peer has stopped reading and its backlog is full.
+    bool send(std::string_view text);
+
+    // Starts a normal close (status 1000); on_close follows once the socket is gone.
+    void close();
+
+private:
+    EpollServer* server_;
+    std::weak_ptr<EpollServer::Connection> conn_;
+};
@@ -0,0 +1,410 @@
+#include "FastJson.h"
+#include <charconv>
+#include "nlohmann/json.hpp"
+
+// ============= Fast-path Scanner =============
+
+namespace {
+
+// Which of the known request fields were present in the scanned object.
+struct FieldsSeen {
+    bool fen = false;
+    bool uci_move = false;
+    bool game_id = false;
+};
+
+class Scanner {
+public:
+    explicit Scanner(std::string_view s) : p_(s.data()), end_(s.data() + s.size()) {}
+
+    bool at_end() const { return p_ == end_; }
+
+    void skip_ws() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) ++p_;
+    }
+
+    bool consume(char c) {
+        if (p_ < end_ && *p_ == c) {
+            ++p_;
+            return true;
+        }
+        return false;
+    }
+
+    // Printable-ASCII string without escapes; anything else is left to nlohmann.
+    bool string(std::string_view& out) {
+        if (!consume('"')) return false;
+        const char* start = p_;
+        while (p_ < end_) {
+            unsigned char c = static_cast<unsigned char>(*p_);
+            if (c == '"') {
+                out = std::string_view(start, static_cast<size_t>(p_ - start));
+                ++p_;
+                return true;
+            }
+            if (c == '\\' || c < 0x20 || c >= 0x80) return false;
+            ++p_;
+        }
+        return false;
+    }
+
+    // Plain JSON integer of at most 9 digits (no fraction or exponent), so it
+    // converts to int exactly like nlohmann's get<int>().
+    bool integer(int& out) {
+        bool negative = consume('-');
+        if (p_ == end_ || *p_ < '0' || *p_ > '9') return false;
+        if (*p_ == '0' && p_ + 1 < end_ && p_[1] >= '0' && p_[1] <= '9') return false;
+        int value = 0;
+        int digits = 0;
+        while (p_ < end_ && *p_ >= '0' && *p_ <= '9') {
+            if (++digits > 9) return false;
+            value = value * 10 + (*p_ - '0');
+            ++p_;
+        }
+        if (p_ < end_ && (*p_ == '.' || *p_ == 'e' || *p_ == 'E')) return false;
+        out = negative ? -value : value;
+        return true;
+    }
+
+    bool literal(std::string_view lit) {
+        if (static_cast<size_t>(end_ - p_) < lit.size()) return false;
+        if (std::string_view(p_, lit.size()) != lit) return false;
+        p_ += lit.size();
+        return true;
+    }
+
+    // Skips the value of a field the endpoint doesn't read. Only scalars are
+    // accepted; nested objects and arrays take the fallback path.
+    bool skip_scalar() {
+        if (p_ == end_) return false;
+        switch (*p_) {
+            case '"': {
+                std::string_view ignored;
+                return string(ignored);
+            }
+            case 't': return literal("true");
+            case 'f': return literal("false");
+            case 'n': return literal("null");
+            default: {
+                int ignored;
+                return integer(ignored);
+            }
+        }
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+};
+
+// Single pass over a flat JSON object. Returns false if the body is outside the
+// subset handled here; out is only written on success.
+bool scan_request(const std::string& body, EngineRequest& out, FieldsSeen& seen) {
+    EngineRequest r;
+    Scanner s(body);
+
+    s.skip_ws();
+    if (!s.consume('{')) return false;
+    s.skip_ws();
+
+    if (!s.consume('}')) {
+        while (true) {
+            std::string_view key;
+            if (!s.string(key)) return false;
+            s.skip_ws();
+            if (!s.consume(':')) return false;
+            s.skip_ws();
+
+            bool ok;
+            if (key == "fen") {
+                ok = s.string(r.fen);
+                seen.fen = true;
+            } else if (key == "uci_move") {
+                ok = s.string(r.uci_move);
+                seen.uci_move = true;
+            } else if (key == "depth") {
+                ok = s.integer(r.depth);
+            } else if (key == "noise") {
+                ok = s.integer(r.noise);
+            } else if (key == "time_ms") {
+                ok = s.integer(r.time_ms);
+            } else if (key == "max_nodes") {
+                ok = s.integer(r.max_nodes);
+            } else if (key == "job_id") {
+                ok = s.string(r.job_id);
+            } else if (key == "game_id") {
+                ok = s.string(r.game_id);
+                seen.game_id = true;
+            } else {
+                ok = s.skip_scalar();
+            }
+            if (!ok) return false;
+
+            s.skip_ws();
+            if (s.consume(',')) {
+                s.skip_ws();
+                continue;
+            }
+            if (s.consume('}')) break;
+            return false;
+        }
+    }
+
+    s.skip_ws();
+    if (!s.at_end()) return false;
+
+    out.fen = r.fen;
+    out.uci_move = r.uci_move;
+    out.depth = r.depth;
+    out.noise = r.noise;
+    out.time_ms = r.time_ms;
+    out.max_nodes = r.max_nodes;
+    out.job_id = r.job_id;
+    out.game_id = r.game_id;
+    return true;
+}
+
+} // namespace
+
+// ============= Request Parsing =============
+
+ParseStatus parse_move_request(const std::string& body, EngineRequest& out) {
+    FieldsSeen seen;
+    if (scan_request(body, out, seen)) {
+        return (seen.fen && seen.uci_move) ? ParseStatus::OK : ParseStatus::MISSING_FIELD;
+    }
+
+    nlohmann::json j;
+    try {
+        j = nlohmann::json::parse(body);
+    } catch (const nlohmann::json::parse_error&) {
+        return ParseStatus::INVALID_JSON;
+    }
+
+    if (!j.contains("fen") || !j.contains("uci_move")) {
+        return ParseStatus::MISSING_FIELD;
+    }
+
+    out.owned_fen      = j["fen"].get<std::string>();
+    out.owned_uci_move = j["uci_move"].get<std::string>();
+    out.fen      = out.owned_fen;
+    out.uci_move = out.owned_uci_move;
+    return ParseStatus::OK;
+}
+
+ParseStatus parse_search_request(const std::string& body, EngineRequest& out) {
+    FieldsSeen seen;
+    if (scan_request(body, out, seen)) {
+        return seen.fen ? ParseStatus::OK : ParseStatus::MISSING_FIELD;
+    }
+
+    nlohmann::json j;
+    try {
+        j = nlohmann::json::parse(body);
+    } catch (const nlohmann::json::parse_error&) {
+        return ParseStatus::INVALID_JSON;
+    }
+
+    if (!j.contains("fen")) {
+        return ParseStatus::MISSING_FIELD;
+    }
+
+    out.owned_fen = j["fen"].get<std::string>();
+    out.fen     = out.owned_fen;
+    out.depth   = j.value("depth", 4);
+    out.noise   = j.value("noise", 0);
+    out.time_ms = j.value("time_ms", 0);
+    out.max_nodes = j.value("max_nodes", 0);
+    if (j.contains("job_id")) {
+        out.owned_job_id = j["job_id"].get<std::string>();
+        out.job_id = out.owned_job_id;
+    }
+    return ParseStatus::OK;
+}
+
+ParseStatus parse_turn_request(const std::string& body, EngineRequest& out) {
+    FieldsSeen seen;
+    if (scan_request(body, out, seen)) {
+        return ((seen.fen || seen.game_id) && seen.uci_move) ? ParseStatus::OK : ParseStatus::MISSING_FIELD;
+    }
+
+    nlohmann::json j;
+    try {
+        j = nlohmann::json::parse(body);
+    } catch (const nlohmann::json::parse_error&) {
+        return ParseStatus::INVALID_JSON;
+    }
+
+    if ((!j.contains("fen") && !j.contains("game_id")) || !j.contains("uci_move")) {
+        return ParseStatus::MISSING_FIELD;
+    }
+
+    if (j.contains("fen")) out.owned_fen = j["fen"].get<std::string>();
+    if (j.contains("game_id")) out.owned_game_id = j["game_id"].get<std::string>();
+    out.owned_uci_move = j["uci_move"].get<std::string>();
+    out.fen      = out.owned_fen;
+    out.game_id  = out.owned_game_id;
+    out.uci_move = out.owned_uci_move;
+    out.depth    = j.value("depth", 4);
+    out.noise    = j.value("noise", 0);
+    out.time_ms  = j.value("time_ms", 0);
+    return ParseStatus::OK;
+}
+
+ParseStatus parse_batch_request(const std::string& body, BatchRequest& out) {
+    nlohmann::json j;
+    try {
+        j = nlohmann::json::parse(body);
+    } catch (const nlohmann::json::parse_error&) {
+        return ParseStatus::INVALID_JSON;
+    }
+    if (!j.is_object()) {
+        return ParseStatus::MISSING_FIELD;
+    }
+
+    out.stream = j.value("stream", false);
+
+    if (j.contains("pairs")) {
+        const auto& pairs = j["pairs"];
+        if (!pairs.is_array()) return ParseStatus::MISSING_FIELD;
+        out.sequence = false;
+        out.fens.reserve(pairs.size());
+        out.uci_moves.reserve(pairs.size());
+        for (const auto& p : pairs) {
+            if (!p.is_object()) return ParseStatus::MISSING_FIELD;
+            auto fen = p.find("fen");
+            auto uci = p.find("uci_move");
+            if (fen == p.end() || uci == p.end() || !fen->is_string() || !uci->is_string()) {
+                return ParseStatus::MISSING_FIELD;
+            }
+            out.fens.push_back(fen->get<std::string>());
+            out.uci_moves.push_back(uci->get<std::string>());
+        }
+        return ParseStatus::OK;
+    }
+
+    if (!j.contains("fen") || !j.contains("uci_moves")) {
+        return ParseStatus::MISSING_FIELD;
+    }
+    const auto& fen = j["fen"];
+    const auto& moves = j["uci_moves"];
+    if (!fen.is_string() || !moves.is_array()) return ParseStatus::MISSING_FIELD;
+    out.sequence = true;
+    out.fen = fen.get<std::string>();
+    out.uci_moves.reserve(moves.size());
+    for (const auto& m : moves) {
+        if (!m.is_string()) return ParseStatus::MISSING_FIELD;
+        out.uci_moves.push_back(m.get<std::string>());
+    }
+    return ParseStatus::OK;
+}
+
+// ============= Response Writing =============
+
+std::string& response_buffer() {
+    thread_local std::string buf = [] {
+        std::string s;
+        s.reserve(512);
+        return s;
+    }();
+    buf.clear();
+    return buf;
+}
+
+void JsonWriter::separate() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    uint64_t bit = 1ULL << level_;
+    if (has_items_ & bit) out_ += ',';
+    has_items_ |= bit;
+}
+
+JsonWriter& JsonWriter::begin_object() {
+    separate();
+    out_ += '{';
+    ++level_;
+    has_items_ &= ~(1ULL << level_);
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_object() {
+    --level_;
+    out_ += '}';
+    return *this;
+}
+
+JsonWriter& JsonWriter::begin_array() {
+    separate();
+    out_ += '[';
+    ++level_;
+    has_items_ &= ~(1ULL << level_);
+    return *this;
+}
+
+JsonWriter& JsonWriter::end_array() {
+    --level_;
+    out_ += ']';
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view k) {
+    separate();
+    write_string(k);
+    out_ += ':';
+    after_key_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view v) {
+    separate();
+    write_string(v);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(int v) {
+    return value(static_cast<long long>(v));
+}
+
+JsonWriter& JsonWriter::value(long long v) {
+    separate();
+    char buf[24];
+    auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), v);
+    out_.append(buf, end);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool v) {
+    separate();
+    out_ += v ? "true" : "false";
+    return *this;
+}
+
+// Same escaping as nlohmann's dump(): short escapes where JSON has them,
+// \u00XX for the remaining control characters, everything else verbatim.
+void JsonWriter::write_string(std::string_view s) {
+    static constexpr char HEX[] = "0123456789abcdef";
+    out_ += '"';
+    for (char ch : s) {
+        unsigned char c = static_cast<unsigned char>(ch);
+        switch (c) {
+            case '"':  out_ += "\\\""; break;
+            case '\\': out_ += "\\\\"; break;
+            case '\b': out_ += "\\b"; break;
+            case '\f': out_ += "\\f"; break;
+            case '\n': out_ += "\\n"; break;
+            case '\r': out_ += "\\r"; break;
+            case '\t': out_ += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    out_ += "\\u00";
+                    out_ += HEX[c >> 4];
+                    out_ += HEX[c & 0xf];
+                } else {
+                    out_ += ch;
+                }
+        }
+    }
+    out_ += '"';
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ============= Request Parsing =============
+
+// Fields read by the engine endpoints. fen and uci_move are views into the request
+// body on the fast path, so they are only valid while the body is alive.
+struct EngineRequest {
+    std::string_view fen;
+    std::string_view uci_move;
+    int depth = 4;
+    int noise = 0;
+    int time_ms = 0;
+    int max_nodes = 0;
+    std::string_view job_id; // /jobs only: client-chosen id, empty if absent
+    std::string_view game_id; // /move-and-reply only: game session, empty if absent
+
+    // Backing storage for the nlohmann fallback path (empty on the fast path).
+    std::string owned_fen;
+    std::string owned_uci_move;
+    std::string owned_job_id;
+    std::string owned_game_id;
+};
+
+enum class ParseStatus {
+    OK,
+    INVALID_JSON,
+    MISSING_FIELD
+};
+
+// Both parsers first try a single-pass scan of the flat request object that copies
+// nothing. Anything outside that subset (escape sequences, non-ASCII, nested values,
+// non-integer numbers, type mismatches, malformed input) falls back to nlohmann::json
+// with the exact checks the handlers used before, so error responses are unchanged.
+// Type errors on present fields still throw, as they always have.
+
+// /move: requires fen and uci_move.
+ParseStatus parse_move_request(const std::string& body, EngineRequest& out);
+
+// /search, /search-stream, /jobs: requires fen; depth, noise, time_ms, max_nodes
+// and job_id are optional.
+ParseStatus parse_search_request(const std::string& body, EngineRequest& out);
+
+// /move-and-reply: requires uci_move and fen, where a game_id may stand in for the
+// fen (see GameSessions.h); depth, noise and time_ms are optional.
+ParseStatus parse_turn_request(const std::string& body, EngineRequest& out);
+
+// /move-batch body: either independent pairs or one start FEN plus a move sequence.
+struct BatchRequest {
+    bool sequence = false;   // true: fen + uci_moves; false: pairs
+    bool stream = false;     // results as SSE events instead of one array
+    std::string fen;                  // sequence mode
+    std::vector<std::string> fens;    // pairs mode, parallel to uci_moves
+    std::vector<std::string> uci_moves;
+};
+
+// Batches are arrays, so this always uses nlohmann; one parse covers every entry.
+// MISSING_FIELD also covers entries of the wrong type.
+ParseStatus parse_batch_request(const std::string& body, BatchRequest& out);
+
+// ============= Response Writing =============
+
+// Per-thread scratch buffer for response bodies. Returned empty; its capacity is kept
+// between requests so steady-state serialization doesn't allocate.
+std::string& response_buffer();
+
+// Appends compact JSON to a caller-owned string. Callers list object keys
+// alphabetically to stay byte-identical with nlohmann's dump() output.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : out_(out) {}
+
+    JsonWriter& begin_object();
+    JsonWriter& end_object();
+    JsonWriter& begin_array();
+    JsonWriter& end_array();
+
+    JsonWriter& key(std::string_view k);
+    JsonWriter& value(std::string_view v);
+    JsonWriter& value(const char* v) { return value(std::string_view(v)); }
+    JsonWriter& value(int v);
+    JsonWriter& value(long long v);
+    JsonWriter& value(bool v);
+
+    template <typename T>
+    JsonWriter& field(std::string_view k, T v) { return key(k).value(v); }
+
+private:
+    void separate();
+    void write_string(std::string_view s);
+
+    std::string& out_;
+    uint64_t has_items_ = 0; // bit per nesting level: level already holds an item
+    int level_ = 0;
+    bool after_key_ = false;
+};
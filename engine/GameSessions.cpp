@@ -0,0 +1,124 @@
+#include "GameSessions.h"
+
+// Plies a session board may advance before reroot() moves it to a fresh Board.
+// Leaves room in the 256-entry undo history for the deepest search line.
+constexpr int REROOT_PLIES = 128;
+
+// ============= GameSession =============
+
+bool GameSession::reset(const std::string& new_fen) {
+    auto fresh = std::make_shared<Board>();
+    try {
+        fresh->setup_with_fen(new_fen);
+    } catch (...) {
+        return false;
+    }
+    board = std::move(fresh);
+    fen = new_fen;
+    hashes.clear();
+    plies_on_board = 0;
+    ponder_move = Move();
+    return true;
+}
+
+void GameSession::play(Move move) {
+    hashes.push_back(board->get_hash());
+    board->move(move);
+    if (board->get_halfmove_clock() == 0) hashes.clear(); // nothing before it can recur
+    plies_since_search++;
+    plies_on_board++;
+}
+
+void GameSession::reroot() {
+    if (plies_on_board < REROOT_PLIES) return;
+    auto fresh = std::make_shared<Board>();
+    if (!fresh->setup_with_packed(board->pack())) return;
+    board = std::move(fresh);
+    plies_on_board = 0;
+}
+
+void GameSession::prepare(SearchLimits& limits) {
+    heuristics.age(plies_since_search);
+    plies_since_search = 0;
+    limits.heuristics = &heuristics;
+    limits.game_hashes = hashes.data();
+    limits.game_hash_count = static_cast<int>(hashes.size());
+}
+
+// ============= GameSessionStore =============
+
+std::shared_ptr<GameSession> GameSessionStore::get(const std::string& game_id) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard lock(mu_);
+    sweep_locked(now);
+
+    auto it = sessions_.find(game_id);
+    if (it != sessions_.end()) {
+        it->second.last_used = now;
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        return it->second.session;
+    }
+
+    auto session = std::make_shared<GameSession>();
+    if (max_sessions_ == 0) return session; // sessions disabled: every turn starts cold
+    lru_.push_front(game_id);
+    sessions_.emplace(game_id, Entry{session, now, lru_.begin()});
+    created_++;
+    evict_over_limit_locked();
+    return session;
+}
+
+void GameSessionStore::set_max_sessions(size_t max_sessions) {
+    std::lock_guard lock(mu_);
+    if (max_sessions_ == 0 || max_sessions == 0) return;
+    max_sessions_ = max_sessions;
+    evict_over_limit_locked();
+}
+
+void GameSessionStore::evict_over_limit_locked() {
+    while (sessions_.size() > max_sessions_) {
+        sessions_.erase(lru_.back());
+        lru_.pop_back();
+        evicted_++;
+    }
+}
+
+std::shared_ptr<GameSession> GameSessionStore::find(const std::string& game_id) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard lock(mu_);
+    sweep_locked(now);
+
+    auto it = sessions_.find(game_id);
+    if (it == sessions_.end()) return nullptr;
+    it->second.last_used = now;
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return it->second.session;
+}
+
+GameSessionStore::Snapshot GameSessionStore::snapshot() {
+    std::lock_guard lock(mu_);
+    sweep_locked(std::chrono::steady_clock::now());
+    return {sessions_.size(), max_sessions_, sessions_.size() * SESSION_BYTES, created_, expired_, evicted_};
+}
+
+// The LRU list is also ordered by last use, so expired sessions are at its tail.
+void GameSessionStore::sweep_locked(std::chrono::steady_clock::time_point now) {
+    while (!lru_.empty()) {
+        auto it = sessions_.find(lru_.back());
+        if (now - it->second.last_used < ttl_) break;
+        sessions_.erase(it);
+        lru_.pop_back();
+        expired_++;
+    }
+}
+
+static GameSessionStore* g_game_sessions = nullptr;
+
+void init_game_sessions(size_t max_sessions, int ttl_ms) {
+    g_game_sessions = new GameSessionStore(max_sessions, ttl_ms);
+}
+
+GameSessionStore& game_sessions() {
+    if (!g_game_sessions) init_game_sessions(1024, 600000);
+    return *g_game_sessions;
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Board.h"
+#include "Search.h"
+
+// ── Game sessions ────────────────────────────────────────────────────────────
+// A bot game sends one /move-and-reply per turn. Without a session each turn
+// parses the FEN into a fresh Board and searches with empty killer and history
+// tables. With a game_id the engine keeps the game's Board after the bot's reply,
+// the positions since the last capture or pawn move (so the search sees
+// repetitions that began before its root) and the move-ordering tables of the
+// previous search, aged to the new root. The next turn then needs only the human
+// move: a request whose fen matches the session, or has none, continues it; a
+// different fen resyncs the session to that position.
+//
+// Sessions are a cache, never the record of the game: one that expires after
+// ttl_ms without a turn, is evicted to stay under max_sessions (least recently
+// used first) or lost with the replica is rebuilt from the caller's fen.
+
+struct GameSession {
+    std::mutex mu; // held for a whole turn, so a game's turns never interleave
+
+    // Valid only while synced. A turn clears synced until it has applied both
+    // moves, so one that fails midway makes the next turn resync from its fen.
+    bool synced = false;
+    std::shared_ptr<Board> board;
+    std::string fen;             // board's position, as the engine last wrote it
+    std::vector<uint64_t> hashes; // earlier positions since the last capture or pawn move, oldest first
+    SearchHeuristics heuristics{};
+    int plies_since_search = 0;  // how far to age heuristics before the next search
+    int plies_on_board = 0;      // moves made on board since it was set up
+    Move ponder_move;            // the human reply the last ponder search expected (Ponder.h)
+
+    // The running ponder search's stop flag. Guarded by ponder_mu rather than mu,
+    // so a turn can stop the search before waiting for the lock it holds.
+    std::mutex ponder_mu;
+    std::shared_ptr<std::atomic<bool>> ponder_cancel;
+
+    // Starts over from fen, keeping the heuristics (a resync is usually the same
+    // game). False, and nothing changed, if fen doesn't parse.
+    bool reset(const std::string& fen);
+
+    // Applies a legal move, recording the position it leaves for repetition checks.
+    void play(Move move);
+
+    // Board keeps at most 256 plies of undo history; long games move to a fresh
+    // Board at the current position before they run out. Call between turns.
+    void reroot();
+
+    // Points limits at this session's heuristics and game history, aging the
+    // heuristics for the plies played since the last search.
+    void prepare(SearchLimits& limits);
+};
+
+class GameSessionStore {
+public:
+    GameSessionStore(size_t max_sessions, int ttl_ms) : max_sessions_(max_sessions), ttl_(ttl_ms) {}
+
+    // The session for game_id, created empty (not synced) if there is none.
+    // Refreshes its place in the eviction order.
+    std::shared_ptr<GameSession> get(const std::string& game_id);
+    // The session for game_id, or nullptr if there is none; never creates one.
+    // Refreshes its place in the eviction order.
+    std::shared_ptr<GameSession> find(const std::string& game_id);
+
+    // Changes the session limit at runtime (MemoryGovernor.h), evicting least
+    // recently used sessions down to it. A disabled store stays disabled.
+    void set_max_sessions(size_t max_sessions);
+
+    struct Snapshot {
+        size_t sessions = 0;
+        size_t max_sessions = 0;
+        size_t bytes = 0; // approximate, from a fixed per-session estimate
+        uint64_t created = 0;
+        uint64_t expired = 0;
+        uint64_t evicted = 0;
+    };
+    Snapshot snapshot();
+
+private:
+    struct Entry {
+        std::shared_ptr<GameSession> session;
+        std::chrono::steady_clock::time_point last_used;
+        std::list<std::string>::iterator lru;
+    };
+
+    // Approximate footprint of one session: its state, its Board and the
+    // store's bookkeeping. Repetition history is extra but small.
+    static constexpr size_t SESSION_BYTES = sizeof(GameSession) + sizeof(Board) + sizeof(Entry) + 64;
+
+    void sweep_locked(std::chrono::steady_clock::time_point now);
+    void evict_over_limit_locked();
+
+    size_t max_sessions_;
+    const std::chrono::milliseconds ttl_;
+    std::mutex mu_;
+    std::unordered_map<std::string, Entry> sessions_;
+    std::list<std::string> lru_; // most recently used first
+    uint64_t created_ = 0;
+    uint64_t expired_ = 0;
+    uint64_t evicted_ = 0;
+};
+
+// Process-wide store. Configure it once at startup, before serving requests.
+void init_game_sessions(size_t max_sessions, int ttl_ms);
+GameSessionStore& game_sessions();
@@ -0,0 +1,58 @@
+#include "LoadReport.h"
+#include <algorithm>
+#include "MemoryGovernor.h"
+#include "Metrics.h"
+#include "Overload.h"
+#include "SearchLane.h"
+#include "SearchScheduler.h"
+
+LoadReport load_report() {
+    LoadReport r;
+    SearchLane::Snapshot lane = search_lane().snapshot();
+    r.running     = lane.running - lane.background;
+    r.background  = lane.background;
+    r.queued      = lane.queued;
+    r.concurrency = search_lane().config().concurrency;
+    r.queue_depth = search_lane().config().queue_depth;
+    if (SearchScheduler* sched = search_scheduler()) {
+        SearchScheduler::Snapshot turns = sched->snapshot();
+        r.cores        = turns.cores;
+        r.core_waiting = turns.waiting;
+    }
+    r.recent_search_ms = recent_search_ms();
+    r.searches = active_searches();
+
+    // Ponder searches give their slot up on demand, so they don't delay anyone.
+    int servers = std::max(1, r.cores > 0 ? r.cores : r.concurrency);
+    int ahead = r.running + r.queued;
+    if (ahead >= servers) {
+        std::vector<int> remaining;
+        for (const ActiveSearch& s : r.searches) {
+            int budget = s.time_ms > 0 ? s.time_ms : std::max(r.recent_search_ms, s.elapsed_ms);
+            remaining.push_back(std::max(0, budget - s.elapsed_ms));
+        }
+        std::sort(remaining.begin(), remaining.end());
+        size_t finished = static_cast<size_t>(ahead - servers); // must finish before this one starts
+        if (finished < remaining.size()) {
+            r.estimated_wait_ms = remaining[finished];
+        } else {
+            int last = remaining.empty() ? 0 : remaining.back();
+            size_t rounds = (finished - remaining.size()) / servers + 1;
+            r.estimated_wait_ms = last + static_cast<int>(rounds) * r.recent_search_ms;
+        }
+    }
+
+    int cpu = g_cpu_percent_x10.load() / 10;
+    int fill = 100 * (lane.running + lane.queued) / std::max(1, r.concurrency + r.queue_depth);
+    r.health = std::clamp(100 - std::max(cpu, fill), 0, 100);
+    if (overload().active()) r.health /= 2;
+    if (memory_governor_stats().step > 0) r.health /= 2;
+    return r;
+}
+
+std::string load_header(const LoadReport& report) {
+    return "wait_ms=" + std::to_string(report.estimated_wait_ms) +
+           ";health=" + std::to_string(report.health) +
+           ";running=" + std::to_string(report.running) +
+           ";queued=" + std::to_string(report.queued);
+}
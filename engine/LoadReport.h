@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Search.h"
+
+// ── Load reports for routing ─────────────────────────────────────────────────
+// What a router needs to pick the least-loaded replica, cheap enough to compute
+// on every search request: served on GET /load and condensed into the
+// X-Engine-Load header of every search response (admitted or refused), so the
+// router's view refreshes with the traffic it sends.
+//
+// estimated_wait_ms is how long a search arriving now would wait to start. With
+// a free server (a scheduler core, or a lane slot without the scheduler) it is 0;
+// otherwise it is when enough of the running searches will have finished, from
+// their remaining time budgets (untimed ones are assumed to take the recent
+// average), plus one average search per round for the rest of the queue.
+//
+// health is 0-100, 100 for an idle replica: 100 minus the larger of CPU use and
+// lane fill (running plus queued over concurrency plus queue depth), halved
+// while overload mode is on and again while the memory governor has shrunk the
+// caches.
+
+struct LoadReport {
+    int running = 0;      // lane slots held by foreground searches
+    int background = 0;   // lane slots held by ponder searches
+    int queued = 0;       // searches waiting for a lane slot
+    int concurrency = 0;
+    int queue_depth = 0;
+    int cores = 0;        // scheduler cores; 0 while the scheduler is off
+    int core_waiting = 0; // admitted searches waiting for a core
+    int recent_search_ms = 0;
+    int estimated_wait_ms = 0;
+    int health = 100;
+    std::vector<ActiveSearch> searches;
+};
+
+LoadReport load_report();
+
+// "wait_ms=120;health=62;running=4;queued=1", the X-Engine-Load header value.
+std::string load_header(const LoadReport& report);
@@ -0,0 +1,117 @@
+#include "MemoryGovernor.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "GameSessions.h"
+#include "ResultCache.h"
+#include "Search.h"
+
+namespace {
+
+MemoryGovernorConfig g_config;
+std::mutex g_mu; // guards g_stats
+MemoryGovernorStats g_stats;
+
+// Full sizes, captured at start.
+size_t g_tt_entries = 0;
+size_t g_cache_capacity = 0;
+size_t g_max_sessions = 0;
+
+size_t scaled(size_t full, int step, size_t floor) {
+    return std::max(std::min(full, floor), full >> step);
+}
+
+void apply(int step) {
+    size_t tt = tt_resize(scaled(g_tt_entries, step, TT_MIN_ENTRIES));
+    size_t cache = scaled(g_cache_capacity, step, g_config.min_cache_entries);
+    size_t sessions = scaled(g_max_sessions, step, g_config.min_sessions);
+    result_cache().set_capacity(cache);
+    game_sessions().set_max_sessions(sessions);
+    std::cout << "Memory governor step " << step << ": TT " << tt << " entries, result cache " << cache
+              << ", sessions " << sessions << "\n";
+}
+
+void governor_loop() {
+    // Past the point where every cache sits at its floor, further steps free nothing.
+    int max_step = 0;
+    while (scaled(g_tt_entries, max_step, TT_MIN_ENTRIES) > TT_MIN_ENTRIES ||
+           scaled(g_cache_capacity, max_step, g_config.min_cache_entries) > g_config.min_cache_entries ||
+           scaled(g_max_sessions, max_step, g_config.min_sessions) > g_config.min_sessions) {
+        max_step++;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    MemoryPressure last = read_memory_pressure();
+    int step = 0;
+    int calm_s = 0;
+    Clock::time_point last_shrink{};
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        MemoryPressure now = read_memory_pressure();
+
+        bool at_limit = now.max_events > last.max_events || now.oom_kills > last.oom_kills;
+        // Reclaimable page cache (TT snapshot writes, say) sits near the limit by
+        // design, so usage counts only what the kernel can't simply drop.
+        double usage_pct = now.limit_bytes > 0 && now.working_bytes >= 0
+                               ? 100.0 * now.working_bytes / now.limit_bytes : 0;
+        bool pressured = at_limit || now.high_events > last.high_events ||
+                         now.some_avg10 >= g_config.pressure_pct ||
+                         (now.limit_bytes > 0 && usage_pct >= g_config.usage_pct);
+        bool calm = !pressured && now.some_avg10 < g_config.pressure_pct / 4.0 &&
+                    usage_pct < g_config.usage_pct - 15;
+        last = now;
+
+        int next = step;
+        calm_s = calm ? calm_s + 1 : 0;
+        if (pressured && step < max_step &&
+            (at_limit || Clock::now() - last_shrink >= std::chrono::seconds(g_config.cooldown_s))) {
+            next = step + 1;
+            last_shrink = Clock::now();
+        } else if (calm_s >= g_config.relax_s && step > 0) {
+            next = step - 1;
+            calm_s = 0;
+        }
+        if (next != step) apply(next);
+
+        std::lock_guard lock(g_mu);
+        if (next > step) g_stats.shrinks++;
+        if (next < step) g_stats.grows++;
+        g_stats.step = step = next;
+        g_stats.pressure = now;
+    }
+}
+
+} // namespace
+
+void start_memory_governor(const MemoryGovernorConfig& config) {
+    if (!config.enabled) return;
+    g_config = config;
+    g_tt_entries = tt_info().entries;
+    g_cache_capacity = result_cache().snapshot().capacity;
+    g_max_sessions = game_sessions().snapshot().max_sessions;
+    {
+        std::lock_guard lock(g_mu);
+        g_stats.enabled = true;
+        g_stats.pressure = read_memory_pressure();
+    }
+    std::thread(governor_loop).detach();
+}
+
+MemoryGovernorStats memory_governor_stats() {
+    std::lock_guard lock(g_mu);
+    return g_stats;
+}
+
+long long process_rss_bytes() {
+    std::ifstream in("/proc/self/statm");
+    long long size, resident;
+    if (!(in >> size >> resident)) return -1;
+    return resident * sysconf(_SC_PAGESIZE);
+}
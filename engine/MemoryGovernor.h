@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include "Cgroup.h"
+
+// ── Memory-pressure shrinking ────────────────────────────────────────────────
+// The TT (256MB at full size), the result cache and the session store are all
+// caches, so under a container memory limit it is better to shrink them than to
+// be OOM-killed with every game on the replica. Once a second the governor reads
+// the cgroup's memory state (Cgroup.h) and counts it as pressure when any of:
+//   - the cgroup's PSI "some" avg10 reaches pressure_pct (tasks stalled on memory),
+//   - memory.current less inactive page cache reaches usage_pct of the tightest
+//     memory.high/max,
+//   - memory.events recorded new high/max throttling or an OOM kill.
+// Under pressure it steps down: each step halves the three caches' sizes (down to
+// their floors), at most once per cooldown_s unless the kernel is already
+// reclaiming at the limit. After relax_s seconds calm (PSI under a quarter of
+// pressure_pct, usage 15 points under usage_pct) it steps back up one level.
+// Shrinking drops the least useful data first: the TT folds dropped slots into
+// the kept ones by depth, the cache and store evict least recently used.
+
+struct MemoryGovernorConfig {
+    bool enabled = true;
+    int pressure_pct = 10;  // PSI some avg10 that counts as pressure
+    int usage_pct = 90;     // memory.current as % of the limit that counts as pressure
+    int cooldown_s = 10;    // least time between two shrink steps
+    int relax_s = 30;       // calm seconds before growing one step
+    size_t min_cache_entries = 1024;
+    size_t min_sessions = 64;
+};
+
+struct MemoryGovernorStats {
+    bool enabled = false;
+    int step = 0;             // halvings currently applied; 0 = full size
+    long long shrinks = 0;
+    long long grows = 0;
+    MemoryPressure pressure;  // last reading
+};
+
+// Starts the governor thread when config.enabled. Sizes at the time of the call
+// are the full sizes it shrinks from and grows back to, so call it after the TT,
+// result cache and session store are configured.
+void start_memory_governor(const MemoryGovernorConfig& config);
+MemoryGovernorStats memory_governor_stats();
+
+// Resident set size of the process, from /proc/self/statm; -1 if unreadable.
+long long process_rss_bytes();
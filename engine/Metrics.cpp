@@ -0,0 +1,98 @@
+#include "Metrics.h"
+#include <dirent.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <thread>
+#include "Cgroup.h"
+
+std::atomic<int> g_searches_in_flight{0};
+std::atomic<int> g_cpu_percent_x10{0};
+std::atomic<int> g_foreground_cpu_percent_x10{0};
+std::atomic<int> g_cpu_capacity_x100{0};
+
+static long long read_cpu_ticks() {
+    std::ifstream f("/proc/self/stat");
+    if (!f.is_open()) return -1;
+    std::string line;
+    std::getline(f, line);
+    std::istringstream ss(line);
+    std::string tok;
+    // fields are 1-indexed; utime=14, stime=15
+    for (int i = 1; i <= 13; i++) ss >> tok;
+    long long utime = 0, stime = 0;
+    ss >> utime >> stime;
+    return utime + stime;
+}
+
+// Ticks that threads running at nice 19 (ponder searches) used since the last
+// call. seen holds every live thread's total at that call; a thread new since
+// then counts from zero.
+static long long read_background_ticks(std::unordered_map<int, long long>& seen) {
+    std::unordered_map<int, long long> now;
+    long long background = 0;
+    DIR* dir = opendir("/proc/self/task");
+    if (!dir) return 0;
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') continue;
+        std::ifstream f(std::string("/proc/self/task/") + entry->d_name + "/stat");
+        std::string line;
+        if (!std::getline(f, line)) continue;
+        // Fields after the parenthesised name, which may contain spaces: state is
+        // field 3, utime 14, stime 15, nice 19.
+        std::istringstream ss(line.substr(line.rfind(')') + 2));
+        std::string tok;
+        for (int i = 3; i <= 13; i++) ss >> tok;
+        long long utime = 0, stime = 0, priority = 0, nice = 0;
+        ss >> utime >> stime >> tok >> tok >> priority >> nice;
+        int tid = std::atoi(entry->d_name);
+        now[tid] = utime + stime;
+        if (nice >= 19) {
+            auto it = seen.find(tid);
+            background += utime + stime - (it == seen.end() ? 0 : it->second);
+        }
+    }
+    closedir(dir);
+    seen = std::move(now);
+    return background;
+}
+
+void track_cpu(std::function<void(int cpus)> on_capacity_change) {
+    double capacity = read_cpu_limits().effective();
+    g_cpu_capacity_x100.store(static_cast<int>(capacity * 100));
+    long long prev = read_cpu_ticks();
+    std::unordered_map<int, long long> thread_ticks;
+    read_background_ticks(thread_ticks);
+    auto prev_t = std::chrono::steady_clock::now();
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        long long cur = read_cpu_ticks();
+        long long background = read_background_ticks(thread_ticks);
+        auto cur_t    = std::chrono::steady_clock::now();
+
+        // Quotas and cpusets can be changed on a running container (docker update).
+        double limit = read_cpu_limits().effective();
+        if (limit != capacity) {
+            bool whole_cpus_changed = std::ceil(limit) != std::ceil(capacity);
+            capacity = limit;
+            g_cpu_capacity_x100.store(static_cast<int>(capacity * 100));
+            if (whole_cpus_changed && on_capacity_change) on_capacity_change(static_cast<int>(std::ceil(capacity)));
+        }
+
+        if (prev >= 0 && cur >= 0) {
+            double elapsed = std::chrono::duration<double>(cur_t - prev_t).count();
+            auto percent = [&](long long ticks) {
+                double pct = ticks / (elapsed * 100.0 * capacity) * 100.0;
+                return static_cast<int>(std::clamp(pct, 0.0, 100.0) * 10);
+            };
+            g_cpu_percent_x10.store(percent(cur - prev));
+            g_foreground_cpu_percent_x10.store(percent(cur - prev - background));
+        }
+        prev = cur;
+        prev_t = cur_t;
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <atomic>
+#include <functional>
+
+// ── Engine-wide metrics ───────────────────────────────────────────────────────
+// Shared by every listener (HTTP and binary) and reported through /stats.
+
+extern std::atomic<int> g_searches_in_flight;
+// cpu_percent stored as integer * 10 (e.g. 753 = 75.3%) for atomic portability,
+// relative to the CPUs the container may use rather than the host's cores
+extern std::atomic<int> g_cpu_percent_x10;
+// The same, leaving out threads at nice 19 (ponder searches, which give way to
+// any other work), so background pondering doesn't read as load
+extern std::atomic<int> g_foreground_cpu_percent_x10;
+// Those CPUs (CpuLimits::effective, see Cgroup.h) * 100
+extern std::atomic<int> g_cpu_capacity_x100;
+
+// Samples /proc/self/stat and the cgroup CPU limits once per second and updates
+// both. When the limits change so that the whole CPUs available (rounded up)
+// differ, on_capacity_change runs on this thread with the new count.
+// Runs forever; start it on a detached thread.
+void track_cpu(std::function<void(int cpus)> on_capacity_change = nullptr);
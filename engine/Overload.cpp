@@ -0,0 +1,41 @@
+#include "Overload.h"
+#include <algorithm>
+#include "Metrics.h"
+#include "SearchLane.h"
+
+bool OverloadGovernor::active() const {
+    SearchLane::Snapshot lane = search_lane().snapshot();
+    if (config_.queue_threshold > 0 && lane.queued >= config_.queue_threshold) return true;
+    // Ponder searches soak up idle cores and yield to any search that needs one,
+    // so CPU they account for is not load.
+    return config_.cpu_percent > 0 && g_foreground_cpu_percent_x10.load() >= config_.cpu_percent * 10;
+}
+
+bool OverloadGovernor::degrade(Board& board, SearchLimits& limits, SearchResult& out) {
+    // TT entries don't know the game's history; a game that has some searches.
+    if (limits.game_hash_count == 0 && tt_result(board, config_.tt_depth, out)) {
+        tt_answers_.fetch_add(1);
+        return true;
+    }
+    limits.depth = std::min(limits.depth, config_.shallow_depth);
+    if (limits.time_ms > 0) limits.time_ms = std::max(1, static_cast<int>(1LL * limits.time_ms * config_.budget_percent / 100));
+    if (limits.max_nodes > 0) limits.max_nodes = std::max(1, static_cast<int>(1LL * limits.max_nodes * config_.budget_percent / 100));
+    shallow_searches_.fetch_add(1);
+    return false;
+}
+
+OverloadGovernor::Snapshot OverloadGovernor::snapshot() const {
+    return {active(), tt_answers_.load(), shallow_searches_.load()};
+}
+
+static OverloadGovernor* g_overload = nullptr;
+
+void init_overload(const OverloadConfig& config) {
+    // Lives for the whole process, like the search lane it watches.
+    g_overload = new OverloadGovernor(config);
+}
+
+OverloadGovernor& overload() {
+    if (!g_overload) init_overload(OverloadConfig{});
+    return *g_overload;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include "Search.h"
+
+// ── Load-aware degradation ───────────────────────────────────────────────────
+// When the search lane backs up or the CPU runs hot, full-budget searches only
+// lengthen the queue. In overload mode bot searches are degraded instead:
+//   1. an exact result-cache hit is served as always;
+//   2. an exact TT entry for the position at least tt_depth deep answers with no
+//      search at all, unless the search carries game history;
+//   3. otherwise the search runs with depth capped at shallow_depth and its time
+//      and node budgets scaled to budget_percent.
+// Responses produced either way carry "degraded": true. Weaker moves during a
+// spike, but tail latency stays bounded.
+
+struct OverloadConfig {
+    int queue_threshold = 4;  // searches waiting in the lane; <= 0 disables
+    int cpu_percent     = 90; // process CPU bar ponder searches, of the CPUs allowed; <= 0 disables
+    int shallow_depth   = 4;
+    int budget_percent  = 25;
+    int tt_depth        = 6;
+};
+
+class OverloadGovernor {
+public:
+    explicit OverloadGovernor(const OverloadConfig& config) : config_(config) {}
+
+    const OverloadConfig& config() const { return config_; }
+
+    // Whether the engine is overloaded right now (lane queue or CPU over threshold).
+    bool active() const;
+
+    // Overload mode for one search: tries the TT, else shrinks limits in place.
+    // Returns true if out already holds the answer.
+    bool degrade(Board& board, SearchLimits& limits, SearchResult& out);
+
+    struct Snapshot {
+        bool active;
+        long long tt_answers;
+        long long shallow_searches;
+    };
+    Snapshot snapshot() const;
+
+private:
+    OverloadConfig config_;
+    std::atomic<long long> tt_answers_{0};
+    std::atomic<long long> shallow_searches_{0};
+};
+
+// Process-wide governor. Configure it once at startup, before serving requests.
+void init_overload(const OverloadConfig& config);
+OverloadGovernor& overload();
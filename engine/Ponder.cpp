@@ -0,0 +1,84 @@
+#include "Ponder.h"
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <thread>
+#include "SearchLane.h"
+
+const char* ponder_outcome_name(PonderOutcome outcome) {
+    switch (outcome) {
+        case PonderOutcome::HIT:  return "hit";
+        case PonderOutcome::MISS: return "miss";
+        case PonderOutcome::NONE: break;
+    }
+    return "";
+}
+
+void Ponderer::start(const std::shared_ptr<GameSession>& session) {
+    if (!config_.enabled) return;
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    {
+        std::lock_guard lock(session->ponder_mu);
+        if (session->ponder_cancel) session->ponder_cancel->store(true);
+        session->ponder_cancel = cancel;
+    }
+    std::thread([this, session, cancel] { run(session, cancel); }).detach();
+}
+
+void Ponderer::stop(GameSession& session) {
+    std::lock_guard lock(session.ponder_mu);
+    if (session.ponder_cancel) session.ponder_cancel->store(true);
+    session.ponder_cancel.reset();
+}
+
+PonderOutcome Ponderer::outcome(GameSession& session, Move human) {
+    if (session.ponder_move == Move()) return PonderOutcome::NONE;
+    bool hit = session.ponder_move == human;
+    session.ponder_move = Move();
+    (hit ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed);
+    return hit ? PonderOutcome::HIT : PonderOutcome::MISS;
+}
+
+// Runs on its own thread; holds the session lock for the whole search.
+void Ponderer::run(std::shared_ptr<GameSession> session, std::shared_ptr<std::atomic<bool>> cancel) {
+    // Linux nice values are per thread: only this search gives way to the rest.
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+
+    std::lock_guard turn(session->mu);
+    if (cancel->load() || !session->synced) return;
+
+    std::shared_ptr<SearchLane::Permit> permit;
+    if (!search_lane().try_acquire_background(permit, [cancel] { cancel->store(true); })) {
+        skipped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    started_.fetch_add(1, std::memory_order_relaxed);
+
+    SearchLimits limits;
+    limits.depth = 64;
+    limits.time_ms = config_.time_ms;
+    limits.cancel = cancel.get();
+    limits.background = true;
+    session->prepare(limits);
+    SearchResult result = search(*session->board, limits, nullptr);
+
+    if (result.depth_completed > 0) session->ponder_move = result.best_move;
+    if (cancel->load()) preempted_.fetch_add(1, std::memory_order_relaxed);
+}
+
+Ponderer::Snapshot Ponderer::snapshot() {
+    return {started_.load(), skipped_.load(), preempted_.load(),
+            hits_.load(), misses_.load(), tt_answers_.load()};
+}
+
+static Ponderer* g_ponder = nullptr;
+
+void init_ponder(const PonderConfig& config) {
+    // Lives for the whole process; detached ponder threads hold references into it.
+    g_ponder = new Ponderer(config);
+}
+
+Ponderer& ponder() {
+    if (!g_ponder) init_ponder(PonderConfig{});
+    return *g_ponder;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "GameSessions.h"
+
+// ── Pondering ────────────────────────────────────────────────────────────────
+// Between the bot's reply and the human's next move the engine would sit idle.
+// A session game instead keeps searching the position the human faces, on a
+// background thread at the lowest CPU priority and only in a free search-lane
+// slot. The search fills the shared TT and the session's move-ordering tables,
+// and its best move is the reply it expects.
+//
+// Pondering never delays foreground work: a search that finds the lane full
+// preempts every ponder search (SearchLane::try_acquire_background), and a turn
+// for the same game stops its ponder before taking the session. When the human
+// plays the expected move (a hit) the bot's position was just searched, so an
+// unnoised search answers straight from the TT if the ponder got deep enough;
+// any other move (a miss) still starts with a warmer TT.
+
+enum class PonderOutcome : uint8_t {
+    NONE, // nothing was pondered for this turn
+    HIT,
+    MISS
+};
+
+// Wire name of an outcome ("hit", "miss"); empty for NONE
+const char* ponder_outcome_name(PonderOutcome outcome);
+
+struct PonderConfig {
+    bool enabled = true;
+    int time_ms = 30000; // longest a ponder search runs if nothing preempts it
+};
+
+class Ponderer {
+public:
+    explicit Ponderer(const PonderConfig& config) : config_(config) {}
+
+    // Called at the end of a turn with the session locked: ponders its position
+    // on a background thread once the turn releases the session.
+    void start(const std::shared_ptr<GameSession>& session);
+
+    // Called before a turn locks the session: stops its ponder search, if any.
+    void stop(GameSession& session);
+
+    // Called with the session locked once the human move is applied. Scores the
+    // last prediction against it and clears it.
+    PonderOutcome outcome(GameSession& session, Move human);
+
+    struct Snapshot {
+        uint64_t started = 0;
+        uint64_t skipped = 0;   // no free lane slot when the session came free
+        uint64_t preempted = 0; // stopped early by a search or the game's next turn
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t tt_answers = 0; // hits answered from the TT without a search
+    };
+    Snapshot snapshot();
+    void count_tt_answer() { tt_answers_.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+    void run(std::shared_ptr<GameSession> session, std::shared_ptr<std::atomic<bool>> cancel);
+
+    PonderConfig config_;
+    std::atomic<uint64_t> started_{0};
+    std::atomic<uint64_t> skipped_{0};
+    std::atomic<uint64_t> preempted_{0};
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> tt_answers_{0};
+};
+
+// Process-wide ponderer. Configure it once at startup, before serving requests.
+void init_ponder(const PonderConfig& config);
+Ponderer& ponder();
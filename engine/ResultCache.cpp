@@ -0,0 +1,78 @@
+#include "ResultCache.h"
+
+ResultCache::ResultCache(size_t capacity)
+    : capacity_(capacity),
+      shard_capacity_((capacity + SHARDS - 1) / SHARDS),
+      shards_(std::make_unique<Shard[]>(SHARDS)) {}
+
+bool ResultCache::lookup(const ResultKey& key, SearchResult& out) {
+    if (capacity_ == 0) return false;
+    Shard& shard = shard_for(key);
+    {
+        std::lock_guard lock(shard.mu);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            out = it->second->second;
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void ResultCache::store(const ResultKey& key, const SearchResult& result) {
+    // A search that completed no depth has nothing worth replaying.
+    if (capacity_ == 0 || result.depth_completed == 0) return;
+    Shard& shard = shard_for(key);
+    std::lock_guard lock(shard.mu);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        it->second->second = result;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+
+    shard.lru.emplace_front(key, result);
+    shard.index.emplace(key, shard.lru.begin());
+    if (shard.lru.size() > shard_capacity_) {
+        shard.index.erase(shard.lru.back().first);
+        shard.lru.pop_back();
+    }
+}
+
+void ResultCache::set_capacity(size_t capacity) {
+    if (capacity_ == 0 || capacity == 0) return;
+    capacity_ = capacity;
+    shard_capacity_ = (capacity + SHARDS - 1) / SHARDS;
+    for (size_t i = 0; i < SHARDS; i++) {
+        Shard& shard = shards_[i];
+        std::lock_guard lock(shard.mu);
+        while (shard.lru.size() > shard_capacity_) {
+            shard.index.erase(shard.lru.back().first);
+            shard.lru.pop_back();
+        }
+    }
+}
+
+ResultCache::Snapshot ResultCache::snapshot() {
+    size_t entries = 0;
+    for (size_t i = 0; i < SHARDS; i++) {
+        std::lock_guard lock(shards_[i].mu);
+        entries += shards_[i].lru.size();
+    }
+    return {entries, capacity_, entries * ENTRY_BYTES, hits_.load(), misses_.load()};
+}
+
+static ResultCache* g_result_cache = nullptr;
+
+void init_result_cache(size_t capacity) {
+    g_result_cache = new ResultCache(capacity);
+}
+
+ResultCache& result_cache() {
+    if (!g_result_cache) init_result_cache(65536);
+    return *g_result_cache;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "Search.h"
+
+// ── Search result cache ──────────────────────────────────────────────────────
+// Final SearchResults of deterministic (noise 0) searches, keyed by position and
+// every limit that shapes the result. Popular post-book positions, repeated hints
+// and retries are answered without searching. Sharded LRU: each shard has its
+// own lock so concurrent lookups rarely contend.
+
+struct ResultKey {
+    uint64_t hash; // Zobrist hash of the root position
+    int depth;
+    int time_ms;
+    int max_nodes;
+    int noise;     // skill; only 0 is cached today, but it stays part of the key
+
+    bool operator==(const ResultKey&) const = default;
+};
+
+inline ResultKey make_result_key(uint64_t hash, const SearchLimits& limits) {
+    return {hash, limits.depth, limits.time_ms, limits.max_nodes, limits.noise};
+}
+
+class ResultCache {
+public:
+    // capacity is the total entry count across shards; 0 disables the cache.
+    explicit ResultCache(size_t capacity);
+
+    // Whether a search with these limits may be cached at all.
+    static bool cacheable(const SearchLimits& limits) { return limits.noise == 0; }
+
+    bool lookup(const ResultKey& key, SearchResult& out);
+    // Only store results of searches that ran to their limits (not cancelled).
+    void store(const ResultKey& key, const SearchResult& result);
+
+    // Changes the total entry count at runtime (MemoryGovernor.h), evicting least
+    // recently used entries down to it. A disabled cache stays disabled.
+    void set_capacity(size_t capacity);
+
+    // Approximate heap footprint of one entry: the LRU node and the index node.
+    static constexpr size_t ENTRY_BYTES =
+        sizeof(std::pair<ResultKey, SearchResult>) + 2 * sizeof(void*) +
+        sizeof(ResultKey) + 4 * sizeof(void*);
+
+    struct Snapshot {
+        size_t entries;
+        size_t capacity;
+        size_t bytes;      // entries * ENTRY_BYTES
+        long long hits;
+        long long misses;
+    };
+    Snapshot snapshot();
+
+private:
+    static constexpr size_t SHARDS = 16;
+
+    struct KeyHash {
+        size_t operator()(const ResultKey& k) const {
+            uint64_t h = k.hash;
+            h ^= (uint64_t(uint32_t(k.depth)) << 1) ^ (uint64_t(uint32_t(k.time_ms)) << 17) ^
+                 (uint64_t(uint32_t(k.max_nodes)) << 29) ^ (uint64_t(uint32_t(k.noise)) << 47);
+            return static_cast<size_t>(h * 0x9E3779B97F4A7C15ULL);
+        }
+    };
+
+    struct Shard {
+        std::mutex mu;
+        // Front is most recently used.
+        std::list<std::pair<ResultKey, SearchResult>> lru;
+        std::unordered_map<ResultKey, decltype(lru)::iterator, KeyHash> index;
+    };
+
+    Shard& shard_for(const ResultKey& key) {
+        // Low hash bits pick the TT slot; use high ones for the shard.
+        return shards_[(key.hash >> 60) % SHARDS];
+    }
+
+    std::atomic<size_t> capacity_;
+    std::atomic<size_t> shard_capacity_;
+    std::unique_ptr<Shard[]> shards_;
+    std::atomic<long long> hits_{0};
+    std::atomic<long long> misses_{0};
+};
+
+// Process-wide cache shared by every search endpoint. Configure it once at startup.
+void init_result_cache(size_t capacity);
+ResultCache& result_cache();
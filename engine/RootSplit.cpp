@@ -0,0 +1,250 @@
+#include "RootSplit.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "httplib.h"
+#include "nlohmann/json.hpp"
+#include "Board.h"
+
+static RootSplitConfig g_config;
+static std::atomic<uint64_t> g_searches{0};
+static std::atomic<uint64_t> g_peer_batches{0};
+static std::atomic<uint64_t> g_peer_failures{0};
+static std::atomic<uint64_t> g_researches{0};
+
+void init_root_split(const RootSplitConfig& config) {
+    g_config = config;
+}
+
+RootSplitStats root_split_stats() {
+    return {static_cast<int>(g_config.peers.size()), g_searches.load(), g_peer_batches.load(),
+            g_peer_failures.load(), g_researches.load()};
+}
+
+namespace {
+
+// One batch of root moves and what became of it.
+struct Batch {
+    int peer = -1;              // index into the peer list; -1 = searched here
+    std::vector<int> indices;   // positions in the root move list
+    std::vector<int> scores;    // for the leading indices that finished
+    bool failed = false;        // peer unreachable or errored; rerun locally
+};
+
+// One iteration's batches, batches[0] being the local one. Shared with the peer
+// threads, which may outlive the iteration if the search is cancelled meanwhile.
+struct PeerRound {
+    std::mutex mu;
+    std::condition_variable cv;
+    std::vector<Batch> batches;
+    int pending = 0;
+    std::atomic<int> nodes{0};
+    // Requests still out, so a cancelled search can hang up on them: the peer
+    // stops its batch when its client goes away.
+    std::vector<httplib::Client*> clients;
+    bool abandoned = false;
+};
+
+void call_peer(const std::string& peer, const std::string& body, int timeout_ms,
+               const std::shared_ptr<PeerRound>& round, size_t index) {
+    bool ok = false;
+    std::vector<int> scores;
+    size_t colon = peer.rfind(':');
+    if (colon != std::string::npos) {
+        httplib::Client client(peer.substr(0, colon), std::atoi(peer.c_str() + colon + 1));
+        client.set_connection_timeout(1);
+        client.set_read_timeout(timeout_ms / 1000, (timeout_ms % 1000) * 1000);
+        // The deadline bounds the peer's search to when this call gives up on it.
+        httplib::Headers headers{{"X-Search-Priority", "bot"}, {"X-Deadline-Ms", std::to_string(timeout_ms)}};
+        bool sent;
+        {
+            std::lock_guard lock(round->mu);
+            sent = !round->abandoned;
+            if (sent) round->clients.push_back(&client);
+        }
+        auto res = sent ? client.Post("/search-moves", headers, body, "application/json") : httplib::Result();
+        {
+            std::lock_guard lock(round->mu);
+            std::erase(round->clients, &client);
+        }
+        if (res && res->status == 200) {
+            try {
+                auto j = nlohmann::json::parse(res->body);
+                scores = j.at("scores").get<std::vector<int>>();
+                round->nodes.fetch_add(j.value("nodes", 0));
+                ok = scores.size() <= round->batches[index].indices.size();
+            } catch (const nlohmann::json::exception&) {
+            }
+        }
+    }
+    std::lock_guard lock(round->mu);
+    Batch& batch = round->batches[index];
+    batch.failed = !ok;
+    if (ok) batch.scores = std::move(scores);
+    round->pending--;
+    round->cv.notify_all();
+}
+
+} // namespace
+
+SearchResult split_search(Board& board, const SearchLimits& limits, DepthCallback on_depth) {
+    if (g_config.peers.empty() || limits.live || limits.depth < g_config.split_depth) {
+        return search(board, limits, std::move(on_depth));
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed_ms = [&] {
+        return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    };
+    auto cancelled = [&] { return limits.cancel && limits.cancel->load(std::memory_order_relaxed); };
+
+    // Shallow iterations locally: cheap, and they leave a best move to lead with.
+    bool stopped = false;
+    SearchLimits shallow = limits;
+    shallow.depth = g_config.split_depth - 1;
+    SearchResult result = search(board, shallow, [&](int d, const std::string& mv, int score, int nodes) {
+        if (on_depth && !on_depth(d, mv, score, nodes)) stopped = true;
+        return !stopped;
+    });
+    if (stopped || result.depth_completed < shallow.depth || cancelled()) return result;
+
+    Move moves[256];
+    int count = board.get_legal_moves(moves);
+    std::stable_partition(moves, moves + count, [&](Move m) { return m == result.best_move; });
+
+    char fen_buf[FEN_MAX_LENGTH];
+    std::string fen(fen_buf, board.write_fen(fen_buf));
+    std::vector<uint64_t> game_hashes(limits.game_hashes, limits.game_hashes + (limits.game_hashes ? limits.game_hash_count : 0));
+    std::vector<bool> alive(g_config.peers.size(), true);
+    g_searches.fetch_add(1);
+
+    // Every search_root_moves call starts its own clock and node count, so each one
+    // gets only what is left of the split's budget after the calls before it.
+    SearchLimits part = limits;
+    auto budget_left = [&](int iteration_nodes) {
+        if (limits.time_ms > 0) {
+            part.time_ms = limits.time_ms - elapsed_ms();
+            if (part.time_ms <= 0) return false;
+        }
+        if (limits.max_nodes > 0) {
+            part.max_nodes = limits.max_nodes - result.nodes - iteration_nodes;
+            if (part.max_nodes <= 0) return false;
+        }
+        return true;
+    };
+
+    for (int d = g_config.split_depth; d <= limits.depth && !stopped; d++) {
+        if (!budget_left(0)) break;
+        int nodes = 0;
+        std::vector<int> scores(count);
+
+        // 1. The expected best move, full window.
+        if (search_root_moves(board, moves, 1, d, INT_MIN + 1, INT_MAX, part, scores.data(), nodes) < 1) {
+            result.nodes += nodes;
+            break;
+        }
+        int alpha = scores[0];
+        Move best = moves[0];
+
+        // 2. Null-window tests of the rest, dealt round-robin to live peers and here.
+        std::vector<int> live_peers;
+        for (size_t p = 0; p < alive.size(); p++) {
+            if (alive[p]) live_peers.push_back(static_cast<int>(p));
+        }
+        auto round = std::make_shared<PeerRound>();
+        std::vector<Batch>& batches = round->batches;
+        batches.resize(live_peers.size() + 1);
+        for (size_t b = 1; b < batches.size(); b++) batches[b].peer = live_peers[b - 1];
+        for (int i = 1; i < count; i++) batches[(i - 1) % batches.size()].indices.push_back(i);
+
+        if (!budget_left(nodes)) {
+            result.nodes += nodes;
+            break;
+        }
+        int timeout_ms = part.time_ms > 0 ? part.time_ms + g_config.peer_slack_ms : 600000;
+        for (size_t b = 1; b < batches.size(); b++) {
+            Batch& batch = batches[b];
+            if (batch.indices.empty()) continue;
+            nlohmann::json body = {
+                {"alpha", alpha}, {"beta", alpha + 1}, {"depth", d}, {"fen", fen},
+                {"game_hashes", game_hashes}, {"noise", part.noise}, {"time_ms", part.time_ms},
+            };
+            for (int i : batch.indices) body["moves"].push_back(moves[i].to_uci());
+            round->pending++;
+            g_peer_batches.fetch_add(1);
+            std::thread(call_peer, g_config.peers[batch.peer], body.dump(), timeout_ms, round, b).detach();
+        }
+
+        auto search_local = [&](Batch& batch) {
+            std::vector<Move> subset;
+            for (int i : batch.indices) subset.push_back(moves[i]);
+            batch.scores.resize(subset.size());
+            int done = !budget_left(nodes) ? 0 : search_root_moves(board, subset.data(), static_cast<int>(subset.size()), d,
+                                         alpha, alpha + 1, part, batch.scores.data(), nodes);
+            batch.scores.resize(done);
+        };
+        search_local(batches[0]);
+
+        {
+            std::unique_lock lock(round->mu);
+            while (round->pending > 0 && !cancelled()) {
+                round->cv.wait_for(lock, std::chrono::milliseconds(20));
+            }
+            if (round->pending > 0) {
+                // Cancelled with peers still out; their threads hold round.
+                round->abandoned = true;
+                for (httplib::Client* client : round->clients) client->stop();
+                result.nodes += nodes;
+                break;
+            }
+        }
+        nodes += round->nodes.load();
+
+        for (size_t b = 1; b < batches.size(); b++) {
+            if (!batches[b].failed) continue;
+            alive[batches[b].peer] = false;
+            g_peer_failures.fetch_add(1);
+            search_local(batches[b]);
+        }
+
+        bool complete = true;
+        for (const Batch& batch : batches) {
+            complete &= batch.scores.size() == batch.indices.size();
+            for (size_t k = 0; k < batch.scores.size(); k++) scores[batch.indices[k]] = batch.scores[k];
+        }
+        if (!complete) {
+            result.nodes += nodes;
+            break;
+        }
+
+        // 3. Moves that refuted the null window get a real one, in move order.
+        for (int i = 1; i < count && !stopped; i++) {
+            if (scores[i] <= alpha) continue;
+            g_researches.fetch_add(1);
+            int score;
+            if (!budget_left(nodes) ||
+                search_root_moves(board, &moves[i], 1, d, alpha, INT_MAX, part, &score, nodes) < 1) {
+                stopped = true;
+                break;
+            }
+            if (score > alpha) {
+                alpha = score;
+                best = moves[i];
+            }
+        }
+        result.nodes += nodes;
+        if (stopped) break;
+
+        result.best_move = best;
+        result.score = alpha;
+        result.depth_completed = d;
+        std::stable_partition(moves, moves + count, [&](Move m) { return m == best; });
+        if (on_depth && !on_depth(d, best.to_uci(), alpha, result.nodes)) break;
+    }
+    return result;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Search.h"
+
+// ── Distributed root splitting ───────────────────────────────────────────────
+// One search normally runs on one core of one replica. With split peers
+// configured (other engine replicas' HTTP addresses), a coordinating replica
+// runs the shallow iterations itself and then, for every iteration from
+// split_depth on:
+//   1. searches the best move so far locally with a full window, which sets
+//      alpha to its score;
+//   2. deals the remaining root moves round-robin to itself and every live peer
+//      (POST /search-moves), each proving with a null window at alpha that its
+//      moves are no better;
+//   3. re-searches, locally and in order, any move that failed high with the
+//      window (alpha, inf), raising alpha when it really is better.
+// That is PVS at the root with the sibling tests spread across machines: the
+// move is chosen by the rule a local search uses, and can only differ from one
+// where the replicas' TTs differ, as between any two runs of the same search.
+//
+// A peer that can't be reached, errors or misses its deadline is dropped for
+// the rest of the search and its moves are searched locally instead, so losing
+// a peer costs time, never the answer. Peers only need the same engine build;
+// several local processes on different ENGINE_HTTP_PORTs can stand in for
+// several nodes.
+//
+// Peer protocol: POST /search-moves with
+//   {"alpha","beta","depth","fen","game_hashes","moves","noise","time_ms"}
+// answered by {"nodes","scores"}: scores for the leading moves that finished,
+// from the root side's point of view (fewer than moves if time ran out).
+
+struct RootSplitConfig {
+    std::vector<std::string> peers; // host:port of peer engines' HTTP listeners
+    int split_depth = 7;            // first iteration worth splitting
+    int peer_slack_ms = 1000;       // wait past the time budget before giving up on a peer
+};
+
+// Configure once at startup, before serving requests.
+void init_root_split(const RootSplitConfig& config);
+
+// search() with its deeper iterations split across the configured peers. Falls
+// back to search() when there are no peers, the search won't reach split_depth,
+// or it has live limits.
+SearchResult split_search(Board& board, const SearchLimits& limits, DepthCallback on_depth = nullptr);
+
+struct RootSplitStats {
+    int peers = 0;
+    uint64_t searches = 0;          // searches that split at least one iteration
+    uint64_t peer_batches = 0;      // move batches sent to peers
+    uint64_t peer_failures = 0;     // batches re-run locally after a peer failed
+    uint64_t researches = 0;        // fail-high moves searched again with a full window
+};
+
+RootSplitStats root_split_stats();
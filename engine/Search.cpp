@@ -1,12 +1,21 @@
 #include "Search.h"
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <algorithm>
+#include <bit>
 #include <chrono>
+#include <cerrno>
 #include <climits>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 // ============= Opening Book =============
@@ -302,10 +311,47 @@ int evaluate(Board& board, int noise) {
 
 // ============= Transposition Table =============
 
-static TTEntry transposition_table[TT_SIZE];
+// Private table by default; tt_attach_shared() may repoint it at a shared mapping
+// before the first search. Untouched pages of the array cost no memory. The mask
+// is atomic because tt_resize() may narrow or widen it while searches probe.
+static TTEntry private_table[TT_SIZE];
+static TTEntry* transposition_table = private_table;
+static std::atomic<uint64_t> tt_mask{TT_SIZE - 1};
+static std::string tt_shared_name;
+static int tt_publish_depth = INT_MAX;
+static TTPublisher tt_publisher = nullptr;
+
+static inline size_t tt_index(uint64_t key) {
+    return key & tt_mask.load(std::memory_order_relaxed);
+}
+
+static inline uint64_t tt_pack(const TTData& d) {
+    return static_cast<uint64_t>(static_cast<uint16_t>(d.score)) |
+           static_cast<uint64_t>(static_cast<uint8_t>(d.depth)) << 16 |
+           static_cast<uint64_t>(d.best_move_raw) << 24 |
+           static_cast<uint64_t>(d.flag) << 40;
+}
+
+static inline TTData tt_unpack(uint64_t data) {
+    return {static_cast<int16_t>(data & 0xFFFF), static_cast<int8_t>((data >> 16) & 0xFF),
+            static_cast<uint16_t>((data >> 24) & 0xFFFF), static_cast<TTFlag>((data >> 40) & 0xFF)};
+}
+
+// Reads key's slot; false unless it holds key (torn slots read as misses).
+static inline bool tt_read(uint64_t key, TTData& out) {
+    TTEntry& e = transposition_table[tt_index(key)];
+    uint64_t data = std::atomic_ref(e.data).load(std::memory_order_relaxed);
+    uint64_t key_xor = std::atomic_ref(e.key_xor).load(std::memory_order_relaxed);
+    if ((key_xor ^ data) != key) return false;
+    out = tt_unpack(data);
+    return true;
+}
 
-static inline int tt_index(uint64_t key) {
-    return key & (TT_SIZE - 1);
+static inline void tt_write(uint64_t key, const TTData& d) {
+    TTEntry& e = transposition_table[tt_index(key)];
+    uint64_t data = tt_pack(d);
+    std::atomic_ref(e.key_xor).store(key ^ data, std::memory_order_relaxed);
+    std::atomic_ref(e.data).store(data, std::memory_order_relaxed);
 }
 
 static void tt_store(uint64_t key, int score, int depth, Move best, TTFlag flag, int ply) {
@@ -314,23 +360,34 @@ static void tt_store(uint64_t key, int score, int depth, Move best, TTFlag flag,
     if (stored_score > 90000)  stored_score += ply;
     else if (stored_score < -90000) stored_score -= ply;
 
-    TTEntry& e = transposition_table[tt_index(key)];
     // Depth-preferred replacement: preserve deep results from being overwritten by
     // shallower searches on the same slot, unless the position is different (collision).
-    if (e.key != key || depth >= static_cast<int>(e.depth)) {
-        e.key          = key;
-        e.score        = static_cast<int16_t>(stored_score);
-        e.depth        = static_cast<int8_t>(depth);
-        e.best_move_raw = static_cast<uint16_t>(best.to_from());
-        e.flag         = flag;
+    TTData old;
+    if (!tt_read(key, old) || depth >= static_cast<int>(old.depth)) {
+        TTData d{static_cast<int16_t>(stored_score), static_cast<int8_t>(depth),
+                 static_cast<uint16_t>(best.to_from()), flag};
+        tt_write(key, d);
+        if (depth >= tt_publish_depth) tt_publisher(key, tt_pack(d));
     }
 }
 
+void tt_set_publisher(int min_depth, TTPublisher publish) {
+    tt_publisher = publish;
+    tt_publish_depth = publish ? min_depth : INT_MAX;
+}
+
+void tt_merge(uint64_t key, uint64_t data) {
+    TTEntry& e = transposition_table[tt_index(key)];
+    TTData held = tt_unpack(std::atomic_ref(e.data).load(std::memory_order_relaxed));
+    TTData incoming = tt_unpack(data);
+    if (incoming.depth > held.depth) tt_write(key, incoming);
+}
+
 // Returns true if we found a usable TT entry. Sets hash_move always if key matches.
 static bool tt_probe(uint64_t key, int depth, int alpha, int beta, int& score,
                      Move& hash_move, int ply) {
-    const TTEntry& e = transposition_table[tt_index(key)];
-    if (e.key != key) return false;
+    TTData e;
+    if (!tt_read(key, e)) return false;
 
     // Always extract hash move for ordering
     hash_move = Move(e.best_move_raw);
@@ -359,6 +416,232 @@ static bool tt_probe(uint64_t key, int depth, int alpha, int beta, int& score,
     return false;
 }
 
+// ============= Shared Table =============
+
+// First 64 bytes of a shared mapping; the entries follow.
+struct SharedTTHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t entry_size;
+    uint64_t entries;
+    uint8_t reserved[40];
+};
+static_assert(sizeof(SharedTTHeader) == 64, "SharedTTHeader should be 64 bytes");
+
+static constexpr uint64_t SHARED_TT_MAGIC = 0x5454737365686343ULL; // "ChessTT" little-endian
+static constexpr uint32_t SHARED_TT_VERSION = 1;
+static constexpr size_t SHARED_TT_ALIGN = 2 << 20; // hugetlbfs sizes are multiples of 2MB
+
+static size_t shared_tt_bytes(size_t entries) {
+    size_t bytes = sizeof(SharedTTHeader) + entries * sizeof(TTEntry);
+    return (bytes + SHARED_TT_ALIGN - 1) / SHARED_TT_ALIGN * SHARED_TT_ALIGN;
+}
+
+static bool valid_header(const SharedTTHeader& h, size_t file_size) {
+    return h.magic == SHARED_TT_MAGIC && h.version == SHARED_TT_VERSION &&
+           h.entry_size == sizeof(TTEntry) && h.entries > 0 && (h.entries & (h.entries - 1)) == 0 &&
+           shared_tt_bytes(h.entries) == file_size;
+}
+
+bool tt_attach_shared(const std::string& name, size_t entries, std::string& error) {
+    if (entries == 0 || (entries & (entries - 1)) != 0) {
+        error = "entry count must be a power of two";
+        return false;
+    }
+    // A path names a file (hugetlbfs, tmpfs volume); anything else a POSIX shm object.
+    bool is_file = name.find('/', 1) != std::string::npos;
+    int fd = is_file ? open(name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600)
+                     : shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        error = std::string("open failed: ") + std::strerror(errno);
+        return false;
+    }
+    // Held while the header is checked or written, so concurrent starters agree.
+    flock(fd, LOCK_EX);
+
+    auto fail = [&](const char* what) {
+        error = std::string(what) + ": " + std::strerror(errno);
+        flock(fd, LOCK_UN);
+        close(fd);
+        return false;
+    };
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0) return fail("fstat failed");
+    size_t size = static_cast<size_t>(st.st_size);
+
+    // Adopt an existing table whatever its size, so every process maps the same one.
+    SharedTTHeader header{};
+    bool adopt = size >= sizeof(header) && pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+                 valid_header(header, size);
+    if (!adopt) {
+        // hugetlbfs can't shrink or resize in place; start from an empty file.
+        if (size != 0 && ftruncate(fd, 0) != 0) return fail("ftruncate failed");
+        size = shared_tt_bytes(entries);
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) return fail("ftruncate failed");
+    }
+
+    void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) return fail("mmap failed");
+    auto* mapped_header = static_cast<SharedTTHeader*>(mapped);
+    if (!adopt) {
+        // The file was just truncated to zero and regrown, so the entries are empty.
+        *mapped_header = {SHARED_TT_MAGIC, SHARED_TT_VERSION, sizeof(TTEntry), entries, {}};
+    }
+    flock(fd, LOCK_UN);
+    close(fd); // the mapping keeps the object alive
+
+    transposition_table = reinterpret_cast<TTEntry*>(static_cast<char*>(mapped) + sizeof(SharedTTHeader));
+    tt_mask.store(mapped_header->entries - 1);
+    tt_shared_name = name;
+    return true;
+}
+
+TTInfo tt_info() {
+    return {static_cast<size_t>(tt_mask.load() + 1), tt_shared_name, transposition_table};
+}
+
+size_t tt_resize(size_t entries) {
+    size_t current = static_cast<size_t>(tt_mask.load() + 1);
+    if (!tt_shared_name.empty()) return current;
+    entries = std::clamp<size_t>(std::bit_floor(std::max<size_t>(entries, 1)), TT_MIN_ENTRIES, TT_SIZE);
+    if (entries == current) return current;
+    tt_mask.store(entries - 1);
+    if (entries > current) return entries; // the new slots are zero pages, read as misses
+
+    // Fold the dropped slots into the ones that now cover their keys (deeper
+    // wins, as with any merge), then hand their pages back to the kernel.
+    for (size_t i = entries; i < current; i++) {
+        TTEntry& e = transposition_table[i];
+        uint64_t data = std::atomic_ref(e.data).load(std::memory_order_relaxed);
+        uint64_t key = std::atomic_ref(e.key_xor).load(std::memory_order_relaxed) ^ data;
+        if (data != 0 && (key & (current - 1)) == i) tt_merge(key, data);
+    }
+    // A search that read the old mask may still write a dropped slot, which
+    // only faults its page back in; the entry is unreachable either way.
+    uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t begin = (reinterpret_cast<uintptr_t>(transposition_table + entries) + page - 1) & ~(page - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(transposition_table + current) & ~(page - 1);
+    if (end > begin) madvise(reinterpret_cast<void*>(begin), end - begin, MADV_DONTNEED);
+    return entries;
+}
+
+size_t tt_resident_bytes() {
+    size_t bytes = static_cast<size_t>(tt_mask.load() + 1) * sizeof(TTEntry);
+    uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t begin = reinterpret_cast<uintptr_t>(transposition_table) & ~(page - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(transposition_table) + bytes;
+    std::vector<unsigned char> resident((end - begin + page - 1) / page);
+    if (mincore(reinterpret_cast<void*>(begin), end - begin, resident.data()) != 0) return bytes;
+    size_t pages = 0;
+    for (unsigned char r : resident) pages += r & 1;
+    return std::min(bytes, pages * page);
+}
+
+// ============= Snapshots =============
+
+struct TTSnapshotHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t entry_size;
+    uint64_t count;
+    uint32_t min_depth;
+    uint32_t reserved;
+};
+static_assert(sizeof(TTSnapshotHeader) == 32, "TTSnapshotHeader should be 32 bytes");
+
+static constexpr uint64_t TT_SNAPSHOT_MAGIC = 0x5354547373656843ULL; // "ChessTTS" little-endian
+static constexpr uint32_t TT_SNAPSHOT_VERSION = 1;
+
+long long tt_save_snapshot(const std::string& path, int min_depth, std::string& error) {
+    std::string tmp = path + ".tmp";
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        error = std::string("open failed: ") + std::strerror(errno);
+        return -1;
+    }
+    auto fail = [&](const char* what) {
+        error = std::string(what) + ": " + std::strerror(errno);
+        close(fd);
+        unlink(tmp.c_str());
+        return -1LL;
+    };
+
+    // Entries go out in chunks behind a header whose count is filled in last.
+    TTSnapshotHeader header{TT_SNAPSHOT_MAGIC, TT_SNAPSHOT_VERSION, sizeof(TTEntry), 0,
+                            static_cast<uint32_t>(std::max(0, min_depth)), 0};
+    if (pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) return fail("write failed");
+    off_t offset = sizeof(header);
+    // Pairs reuse TTEntry's layout, with the plain key in key_xor.
+    std::vector<TTEntry> chunk;
+    chunk.reserve(4096);
+    auto flush = [&] {
+        size_t bytes = chunk.size() * sizeof(TTEntry);
+        if (pwrite(fd, chunk.data(), bytes, offset) != static_cast<ssize_t>(bytes)) return false;
+        offset += static_cast<off_t>(bytes);
+        header.count += chunk.size();
+        chunk.clear();
+        return true;
+    };
+
+    for (uint64_t i = 0, mask = tt_mask.load(); i <= mask; i++) {
+        TTEntry& e = transposition_table[i];
+        uint64_t data = std::atomic_ref(e.data).load(std::memory_order_relaxed);
+        uint64_t key = std::atomic_ref(e.key_xor).load(std::memory_order_relaxed) ^ data;
+        // A torn slot yields a key that doesn't index to it (almost always).
+        if (tt_unpack(data).depth < min_depth || tt_index(key) != i) continue;
+        chunk.push_back({key, data});
+        if (chunk.size() == chunk.capacity() && !flush()) return fail("write failed");
+    }
+    if (!flush()) return fail("write failed");
+    if (pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) return fail("write failed");
+    if (fsync(fd) != 0) return fail("fsync failed");
+    close(fd);
+    if (rename(tmp.c_str(), path.c_str()) != 0) {
+        error = std::string("rename failed: ") + std::strerror(errno);
+        unlink(tmp.c_str());
+        return -1;
+    }
+    return static_cast<long long>(header.count);
+}
+
+long long tt_load_snapshot(const std::string& path, std::string& error) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = std::string("open failed: ") + std::strerror(errno);
+        return -1;
+    }
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TTSnapshotHeader)) {
+        error = "not a TT snapshot";
+        close(fd);
+        return -1;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        error = std::string("mmap failed: ") + std::strerror(errno);
+        return -1;
+    }
+
+    const auto* header = static_cast<const TTSnapshotHeader*>(mapped);
+    long long loaded = -1;
+    if (header->magic != TT_SNAPSHOT_MAGIC || header->version != TT_SNAPSHOT_VERSION ||
+        header->entry_size != sizeof(TTEntry)) {
+        error = "not a version " + std::to_string(TT_SNAPSHOT_VERSION) + " TT snapshot";
+    } else if (size != sizeof(TTSnapshotHeader) + header->count * sizeof(TTEntry)) {
+        error = "truncated snapshot";
+    } else {
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        const auto* entries = reinterpret_cast<const TTEntry*>(header + 1);
+        for (uint64_t i = 0; i < header->count; i++) tt_merge(entries[i].key_xor, entries[i].data);
+        loaded = static_cast<long long>(header->count);
+    }
+    munmap(mapped, size);
+    return loaded;
+}
+
 // ============= Move Scoring =============
 
 static constexpr int HASH_MOVE_SCORE  = 10000000;
@@ -477,6 +760,11 @@ static int negamax(Board& board, int depth, int alpha, int beta,
     for (int i = ply - 2; i >= 0; i -= 2) {
         if (ctx->path_hashes[i] == hash) return 0;
     }
+    // Same for the game before the root (sessions): entry i lies ply + count - i
+    // plies back, so only every other entry can have this side to move.
+    for (int i = ctx->game_hash_count - 2 + (ply & 1); i >= 0; i -= 2) {
+        if (ctx->game_hashes[i] == hash) return 0;
+    }
     ctx->path_hashes[ply] = hash;
 
     if (board.get_halfmove_clock() >= 100 || board.is_insufficient_material()) {
@@ -605,9 +893,176 @@ static int negamax(Board& board, int depth, int alpha, int beta,
     return best;
 }
 
+// ============= Principal Variation =============
+
+int principal_variation(Board& board, Move first, Move* out, int max_length) {
+    uint64_t seen[MAX_PV_LENGTH + 1];
+    seen[0] = board.get_hash();
+    max_length = std::min(max_length, MAX_PV_LENGTH);
+
+    int length = 0;
+    Move next = first;
+    while (length < max_length && next != Move()) {
+        // TT moves can be stale after a collision; only follow legal ones.
+        Move legal[256];
+        int count = board.get_legal_moves(legal);
+        Move found;
+        for (int i = 0; i < count; i++) {
+            if (legal[i] == next) {
+                found = legal[i];
+                break;
+            }
+        }
+        if (found == Move()) break;
+
+        board.move(found);
+        out[length++] = found;
+
+        uint64_t hash = board.get_hash();
+        bool repeated = false;
+        for (int i = 0; i < length; i++) repeated |= seen[i] == hash;
+        seen[length] = hash;
+        if (repeated) break;
+
+        TTData e;
+        next = tt_read(hash, e) ? Move(e.best_move_raw) : Move();
+    }
+
+    for (int i = length - 1; i >= 0; i--) board.undo_move(out[i]);
+    return length;
+}
+
+bool tt_result(Board& board, int min_depth, SearchResult& out) {
+    uint64_t hash = board.get_hash();
+    TTData e;
+    if (!tt_read(hash, e) || e.depth < min_depth || e.flag != TT_EXACT) return false;
+
+    Move legal[256];
+    int count = board.get_legal_moves(legal);
+    for (int i = 0; i < count; i++) {
+        if (legal[i] == Move(e.best_move_raw)) {
+            out.best_move = legal[i];
+            out.score = e.score;
+            out.nodes = 0;
+            out.depth_completed = e.depth;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============= Scheduling Hooks =============
+
+static SearchHooks search_hooks;
+
+void search_set_hooks(const SearchHooks& hooks) {
+    search_hooks = hooks;
+}
+
+// Registry behind active_searches(). Entries live in their HookScope, on the
+// search's stack; nested search calls aren't registered again.
+struct ActiveEntry {
+    std::chrono::steady_clock::time_point start;
+    int depth;
+    int time_ms;
+    int max_nodes;
+};
+static std::mutex active_mu;
+static std::vector<const ActiveEntry*> active_entries;
+static double recent_ms = 0;
+static thread_local int active_nesting = 0;
+
+// Brackets one search call with the begin/end hooks and registers it as active.
+struct HookScope {
+    ActiveEntry entry;
+    bool registered;
+
+    explicit HookScope(const SearchLimits& limits)
+        : entry{std::chrono::steady_clock::now(), limits.depth, limits.time_ms, limits.max_nodes},
+          registered(active_nesting++ == 0 && !limits.background) {
+        if (registered) {
+            std::lock_guard lock(active_mu);
+            active_entries.push_back(&entry);
+        }
+        if (search_hooks.begin) search_hooks.begin(limits);
+    }
+    ~HookScope() {
+        if (search_hooks.end) search_hooks.end();
+        active_nesting--;
+        if (!registered) return;
+        std::lock_guard lock(active_mu);
+        std::erase(active_entries, &entry);
+        if (entry.time_ms > 0) {
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - entry.start).count();
+            recent_ms = recent_ms == 0 ? ms : 0.8 * recent_ms + 0.2 * ms;
+        }
+    }
+};
+
+std::vector<ActiveSearch> active_searches() {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard lock(active_mu);
+    std::vector<ActiveSearch> out;
+    out.reserve(active_entries.size());
+    for (const ActiveEntry* e : active_entries) {
+        int elapsed = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(now - e->start).count());
+        out.push_back({e->depth, e->time_ms, e->max_nodes, elapsed});
+    }
+    return out;
+}
+
+int recent_search_ms() {
+    std::lock_guard lock(active_mu);
+    return static_cast<int>(recent_ms);
+}
+
+int search_root_moves(Board& board, const Move* moves, int count, int depth, int alpha, int beta,
+                      const SearchLimits& limits, int* scores, int& nodes) {
+    SearchContext ctx;
+    ctx.clear();
+    ctx.path_hashes[0] = board.get_hash();
+    ctx.start_time = std::chrono::steady_clock::now();
+    HookScope scope(limits);
+    ctx.time_ms = limits.time_ms;
+    ctx.cancel = limits.cancel;
+    ctx.node_limit = limits.max_nodes;
+    ctx.game_hashes = limits.game_hashes;
+    ctx.game_hash_count = limits.game_hashes ? limits.game_hash_count : 0;
+    ctx.yield = search_hooks.yield;
+
+    int done = 0;
+    for (; done < count; done++) {
+        board.move(moves[done]);
+        int score = -negamax(board, depth - 1, -beta, -alpha, &ctx, 1, false, limits.noise);
+        board.undo_move(moves[done]);
+        if (ctx.stop_flag.load(std::memory_order_relaxed)) break;
+        scores[done] = score;
+    }
+    nodes += ctx.nodes;
+    return done;
+}
+
 // ============= Top-level Search (Iterative Deepening) =============
 
 SearchResult search(Board& board, int depth, int noise, int time_ms, DepthCallback on_depth) {
+    SearchLimits limits;
+    limits.depth = depth;
+    limits.noise = noise;
+    limits.time_ms = time_ms;
+    return search(board, limits, std::move(on_depth));
+}
+
+SearchResult search(Board& board, const SearchLimits& limits, DepthCallback on_depth) {
+    const int noise = limits.noise;
+    const int time_ms = limits.time_ms;
+    const LiveLimits* live = limits.live;
+    auto max_depth = [&] {
+        return live ? std::clamp(live->depth.load(std::memory_order_relaxed), 1, 64) : limits.depth;
+    };
+    auto max_nodes = [&] {
+        return live ? live->max_nodes.load(std::memory_order_relaxed) : limits.max_nodes;
+    };
+
     SearchResult result;
     result.best_move = Move();
     result.score = INT_MIN;
@@ -633,13 +1088,25 @@ SearchResult search(Board& board, int depth, int noise, int time_ms, DepthCallba
     // TT persists across calls (static array) — no clearing needed
 
     ctx.start_time = std::chrono::steady_clock::now();
+    HookScope scope(limits); // after the clock starts, so waiting for a core counts
     ctx.time_ms = time_ms;
-    bool timed = time_ms > 0;
+    ctx.cancel = limits.cancel;
+    ctx.live = live;
+    ctx.game_hashes = limits.game_hashes;
+    ctx.game_hash_count = limits.game_hashes ? limits.game_hash_count : 0;
+    ctx.yield = search_hooks.yield;
+    if (limits.heuristics) {
+        std::memcpy(ctx.killers, limits.heuristics->killers, sizeof(ctx.killers));
+        std::memcpy(ctx.history, limits.heuristics->history, sizeof(ctx.history));
+    }
 
     // Iterative deepening with clean PVS on every iteration.
     // Noise is threaded into evaluate() at leaf nodes — no root perturbation needed.
-    for (int d = 1; d <= depth; d++) {
+    for (int d = 1; d <= max_depth(); d++) {
         ctx.nodes = 0;
+        ctx.prior_nodes = result.nodes;
+        if (limits.max_nodes > 0) ctx.node_limit = std::max(1, limits.max_nodes - result.nodes);
+        ctx.refresh_live();
 
         int alpha = INT_MIN + 1;
         int beta  = INT_MAX;
@@ -699,12 +1166,20 @@ SearchResult search(Board& board, int depth, int noise, int time_ms, DepthCallba
         }
         result.nodes += ctx.nodes;
 
+        if (limits.cancel && limits.cancel->load(std::memory_order_relaxed)) break;
+        if (max_nodes() > 0 && result.nodes >= max_nodes()) break;
+
         // Check time after each completed depth iteration.
-        if (timed) {
+        ctx.refresh_live();
+        if (ctx.time_ms > 0) {
             ctx.check_time();
             if (ctx.stop_flag.load(std::memory_order_relaxed)) break;
         }
     }
 
+    if (limits.heuristics) {
+        std::memcpy(limits.heuristics->killers, ctx.killers, sizeof(ctx.killers));
+        std::memcpy(limits.heuristics->history, ctx.history, sizeof(ctx.history));
+    }
     return result;
 }
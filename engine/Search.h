@@ -2,12 +2,14 @@
 
 #include "Board.h"
 #include "Move.h"
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <cstring>
 #include <functional>
 #include <string>
+#include <vector>
 
 // ============= Transposition Table =============
 
@@ -17,18 +19,129 @@ enum TTFlag : uint8_t {
     TT_BETA   // lower bound (failed high)
 };
 
-struct TTEntry {
-    uint64_t key;
+// Decoded contents of a TT slot.
+struct TTData {
     int16_t score;
     int8_t depth;
     uint16_t best_move_raw;
     TTFlag flag;
-    uint8_t pad;
+};
+
+// Lock-free slot: data packs a TTData and key_xor is the position key XOR data.
+// Both words are written and read as independent relaxed atomics, so a reader
+// racing a writer (another search thread, or another process sharing the table)
+// may pair one store's data with another's key_xor; the XOR then no longer gives
+// the probed key and the torn slot reads as a miss, never as a wrong entry.
+struct TTEntry {
+    uint64_t key_xor;
+    uint64_t data;
 };
 
 static_assert(sizeof(TTEntry) == 16, "TTEntry should be 16 bytes");
 
 constexpr int TT_SIZE = 1 << 24; // ~256MB, supports Depth 14+ without overwriting root nodes
+constexpr int TT_MIN_ENTRIES = 1 << 16; // 1MB, the floor tt_resize() shrinks to
+
+// Moves the TT from process memory into a shared mapping that every engine
+// process on the host attaching the same name uses: a POSIX shared-memory object
+// for a name like "/chess-tt", or a file for a path like "/dev/hugepages/chess-tt"
+// (hugetlbfs) or one on a tmpfs volume mounted into several containers. The
+// mapping outlives the processes, so a restart reattaches to a warm table.
+// The first process creates it with `entries` slots (a power of two); later ones
+// adopt the existing size. Call once at startup, before any search. On failure
+// returns false with a reason and the process keeps its private table.
+bool tt_attach_shared(const std::string& name, size_t entries, std::string& error);
+
+// Entries at least min_depth deep are handed to publish as the search stores them
+// (key and packed data word, as in TTEntry), e.g. to share them with other hosts.
+// publish runs on search threads, so it must only queue. Set once at startup.
+using TTPublisher = void (*)(uint64_t key, uint64_t data);
+void tt_set_publisher(int min_depth, TTPublisher publish);
+
+// Stores an entry that came from elsewhere (a peer's published data word). It
+// replaces the slot only if it is deeper than what the slot holds, whichever
+// position that is, so remote entries never push out better local ones.
+void tt_merge(uint64_t key, uint64_t data);
+
+struct TTInfo {
+    size_t entries;
+    std::string shared; // empty while the table is private
+    void* memory;       // the entries, for memory placement (Affinity.h)
+};
+TTInfo tt_info();
+
+// Changes how many slots of the private table are in use, rounded down to a power
+// of two between TT_MIN_ENTRIES and TT_SIZE, while searches run. Shrinking folds
+// the dropped slots' entries into the remaining ones and returns their pages to
+// the kernel; growing starts the new slots empty. A shared table keeps its size.
+// Returns the entry count now in use.
+size_t tt_resize(size_t entries);
+
+// Bytes of the table in use that are resident in memory (mincore).
+size_t tt_resident_bytes();
+
+// Snapshot files let a restarted engine begin with the deep part of its old
+// table. A snapshot is a 32-byte header (magic "ChessTTS", version, entry size,
+// count, min_depth) followed by count (u64 key, u64 data) pairs in host byte
+// order; it only ever goes back to the host that wrote it. Keys are stored
+// whole, so a snapshot restores into a table of any size.
+//
+// tt_save_snapshot writes the entries at least min_depth deep to path through a
+// temporary file and a rename, so a crash mid-write leaves the old snapshot.
+// Safe while searches run; slots torn by a concurrent write are skipped. Returns
+// the number of entries written, or -1 with error set.
+long long tt_save_snapshot(const std::string& path, int min_depth, std::string& error);
+
+// Maps a snapshot read-only and merges its entries (tt_merge, so they never
+// replace deeper ones). Returns the number of entries read, or -1 with error set
+// if the file is missing, of another version or truncated.
+long long tt_load_snapshot(const std::string& path, std::string& error);
+
+// ============= Live Limits =============
+
+// Limits a caller can change while a search runs (WebSocket change-limits and
+// ponder-hit). The search rereads them before every iteration and at every clock
+// check. time_ms counts from clock_start, which the caller sets before searching
+// and may move forward later.
+struct LiveLimits {
+    std::atomic<int> depth{4};
+    std::atomic<int> time_ms{0};   // 0 = no time limit
+    std::atomic<int> max_nodes{0}; // 0 = no node budget
+    std::atomic<std::chrono::steady_clock::rep> clock_start{0};
+
+    void restart_clock() {
+        clock_start.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                          std::memory_order_relaxed);
+    }
+};
+
+// ============= Search Heuristics =============
+
+// Move-ordering tables a caller can carry from one search to the next (game
+// sessions), so a search starts warm instead of from zeroed tables.
+struct SearchHeuristics {
+    Move killers[64][2];    // [ply][slot]
+    int history[2][64][64]; // [color][from][to]
+
+    void clear() {
+        std::memset(killers, 0, sizeof(killers));
+        std::memset(history, 0, sizeof(history));
+    }
+
+    // Ages the tables for a root `plies` further into the game: killers move to
+    // the plies they now correspond to and history scores are halved.
+    void age(int plies) {
+        if (plies <= 0) return;
+        for (int ply = 0; ply < 64; ply++) {
+            bool valid = ply + plies < 64;
+            killers[ply][0] = valid ? killers[ply + plies][0] : Move();
+            killers[ply][1] = valid ? killers[ply + plies][1] : Move();
+        }
+        for (auto& side : history)
+            for (auto& from : side)
+                for (int& h : from) h /= 2;
+    }
+};
 
 // ============= Search Context =============
 
@@ -38,22 +151,57 @@ struct SearchContext {
     int history[2][64][64]; // [color][from][to]
     uint64_t path_hashes[256]; // Zobrist hashes of positions on the current search path,
                                 // indexed by ply. Used to detect in-search repetitions.
-    std::atomic<bool> stop_flag{false}; // set when time limit expires
+    std::atomic<bool> stop_flag{false}; // set when time limit expires or the caller cancels
     std::chrono::steady_clock::time_point start_time;
     int time_ms = 0; // 0 = no time limit
+    const std::atomic<bool>* cancel = nullptr; // external stop request, polled with the clock
+    int node_limit = 0; // > 0: stop once the current iteration has searched this many nodes
+    const LiveLimits* live = nullptr; // if set, time_ms, start_time and node_limit follow it
+    int prior_nodes = 0; // nodes of completed iterations, for live node budgets
+    const uint64_t* game_hashes = nullptr; // earlier game positions, see SearchLimits
+    int game_hash_count = 0;
+    void (*yield)() = nullptr; // SearchHooks::yield, run at every clock check
 
     void clear() {
         nodes = 0;
         time_ms = 0;
+        cancel = nullptr;
+        node_limit = 0;
+        live = nullptr;
+        prior_nodes = 0;
+        game_hashes = nullptr;
+        game_hash_count = 0;
+        yield = nullptr;
         stop_flag.store(false, std::memory_order_relaxed);
         std::memset(killers, 0, sizeof(killers));
         std::memset(history, 0, sizeof(history));
         // path_hashes are written before being read, no memset needed
     }
 
-    // Check elapsed time every N nodes; set stop_flag if over budget.
+    // Pulls the current live limits (if any) into the fields check_time reads.
+    inline void refresh_live() {
+        if (!live) return;
+        time_ms = live->time_ms.load(std::memory_order_relaxed);
+        start_time = std::chrono::steady_clock::time_point(
+            std::chrono::steady_clock::duration(live->clock_start.load(std::memory_order_relaxed)));
+        int max_nodes = live->max_nodes.load(std::memory_order_relaxed);
+        node_limit = max_nodes > 0 ? std::max(1, max_nodes - prior_nodes) : 0;
+    }
+
+    // Check elapsed time and cancellation every N nodes; set stop_flag if either fires.
     inline void check_time() {
-        if (time_ms > 0 && (nodes & 4095) == 0) {
+        if ((nodes & 4095) != 0) return;
+        if (yield) yield(); // may block; the checks below then see the time it took
+        refresh_live();
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            stop_flag.store(true, std::memory_order_relaxed);
+            return;
+        }
+        if (node_limit > 0 && nodes >= node_limit) {
+            stop_flag.store(true, std::memory_order_relaxed);
+            return;
+        }
+        if (time_ms > 0) {
             auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
                 std::chrono::steady_clock::now() - start_time).count();
             if (elapsed >= time_ms)
@@ -75,13 +223,89 @@ struct SearchResult {
 // Return true to continue searching, false to abort early.
 using DepthCallback = std::function<bool(int depth, const std::string& best_move, int score, int nodes)>;
 
+// Limits and controls for a single search call.
+struct SearchLimits {
+    int depth = 4;
+    int noise = 0;   // > 0 perturbs leaf evaluations (centipawns) for weaker bots
+    int time_ms = 0; // > 0 enables time-limited search
+    int max_nodes = 0; // > 0 caps total nodes across iterations (checked every 4096 nodes)
+    // If set, storing true stops the search within a few thousand nodes. The result
+    // then holds the last completed depth (a null move if none completed).
+    const std::atomic<bool>* cancel = nullptr;
+    // If set, its depth, time_ms and max_nodes replace the fields above and may
+    // change mid-search. Depth is clamped to 1-64.
+    const LiveLimits* live = nullptr;
+    // If set, seeds killers and history and receives them back afterwards.
+    SearchHeuristics* heuristics = nullptr;
+    // Zobrist hashes of the game's earlier positions since the last capture or pawn
+    // move, oldest first, ending just before the root. A line that returns to one
+    // of them is scored as a repetition draw.
+    const uint64_t* game_hashes = nullptr;
+    int game_hash_count = 0;
+    // Speculative work (pondering) that gives way on demand; left out of
+    // active_searches() and recent_search_ms().
+    bool background = false;
+};
+
 // Run iterative-deepening negamax with alpha-beta pruning from the given position.
-// noise > 0 perturbs leaf evaluations (centipawns) for weaker bots.
-// time_ms > 0 enables time-limited search (breaks after each completed depth iteration).
 // on_depth, if set, is called after each completed depth iteration.
+SearchResult search(Board& board, const SearchLimits& limits, DepthCallback on_depth = nullptr);
+
+// Convenience overload for callers that only set depth, noise and time.
 SearchResult search(Board& board, int depth, int noise = 0, int time_ms = 0,
                     DepthCallback on_depth = nullptr);
 
+// Longest line principal_variation() will report.
+constexpr int MAX_PV_LENGTH = 32;
+
+// Reconstructs the expected line from the position, starting with first (the search's
+// best move) and following TT best moves while they stay legal and don't repeat.
+// Writes up to max_length moves to out and returns the count; the board is restored.
+// Must not be called while a search on the same board is between make and unmake.
+int principal_variation(Board& board, Move first, Move* out, int max_length);
+
+// Answers from the transposition table alone: if the position has an entry at
+// least min_depth deep whose move is legal there, fills out (nodes = 0) and returns
+// true. Lets an overloaded engine reply without searching.
+bool tt_result(Board& board, int min_depth, SearchResult& out);
+
+// Searches each root move to depth (the move itself being ply 1) inside the window
+// [alpha, beta], scores from the root side's point of view -- one iteration of the
+// root loop, for a subset of moves. Used by root-splitting coordinators and the
+// peers serving them (RootSplit.h). Honours noise, cancel, time_ms, max_nodes and
+// game_hashes from limits. Returns how many leading moves were fully searched;
+// their scores go to scores. Nodes searched are added to nodes.
+int search_root_moves(Board& board, const Move* moves, int count, int depth, int alpha, int beta,
+                      const SearchLimits& limits, int* scores, int& nodes);
+
+// ============= Scheduling Hooks =============
+
+// Lets a scheduler decide which searches get a core (SearchScheduler.h). Every
+// search() and search_root_moves() call runs begin on its own thread before its
+// first node and end after its last; yield runs at each clock check (every 4096
+// nodes). begin and yield may block, which only pauses the search: its clock
+// keeps running, so time limits still hold. Unset hooks cost one branch per clock
+// check. Set once at startup, before any search.
+struct SearchHooks {
+    void (*begin)(const SearchLimits& limits) = nullptr;
+    void (*yield)() = nullptr;
+    void (*end)() = nullptr;
+};
+void search_set_hooks(const SearchHooks& hooks);
+
+// Searches running right now (outermost search calls only, whether computing or
+// waiting for a core), for load reports.
+struct ActiveSearch {
+    int depth;
+    int time_ms;    // 0 = no time limit
+    int max_nodes;  // 0 = no node budget
+    int elapsed_ms;
+};
+std::vector<ActiveSearch> active_searches();
+
+// Moving average of how long recent timed searches took, in ms (0 before any).
+int recent_search_ms();
+
 // Static evaluation of the position (centipawns, positive = good for side to move).
 // noise > 0 adds random perturbation to the evaluation.
 int evaluate(Board& board, int noise = 0);
@@ -0,0 +1,86 @@
+#include "SearchCoalescer.h"
+#include <chrono>
+
+// ============= SharedSearch =============
+
+void SharedSearch::publish(DepthEvent event) {
+    {
+        std::lock_guard lock(mu_);
+        events_.push_back(std::move(event));
+    }
+    cv_.notify_all();
+}
+
+void SharedSearch::finish(const SearchResult& result) {
+    {
+        std::lock_guard lock(mu_);
+        result_ = result;
+        finished_ = true;
+    }
+    cv_.notify_all();
+}
+
+bool SharedSearch::wait(size_t& next, std::vector<DepthEvent>& out, SearchResult& result, int wait_ms) {
+    std::unique_lock lock(mu_);
+    cv_.wait_for(lock, std::chrono::milliseconds(wait_ms), [&] {
+        return finished_ || next < events_.size();
+    });
+    out.assign(events_.begin() + static_cast<std::ptrdiff_t>(next), events_.end());
+    next = events_.size();
+    if (finished_) result = result_;
+    return finished_;
+}
+
+void SharedSearch::Subscription::leave() {
+    if (left_) return;
+    left_ = true;
+    search_coalescer().leave(*search_, counted_);
+}
+
+// ============= SearchCoalescer =============
+
+std::shared_ptr<SharedSearch::Subscription> SearchCoalescer::join(const ResultKey& key, bool create, bool& created) {
+    std::lock_guard lock(mu_);
+    created = false;
+
+    auto it = live_.find(key);
+    // A cancelled search is winding down with nobody left to serve; start afresh.
+    if (it != live_.end() && !it->second->cancelled()) {
+        if (!create && followers_ >= max_followers_) return nullptr;
+        if (!create) followers_++;
+        it->second->subscribers_++;
+        joined_++;
+        return std::make_shared<SharedSearch::Subscription>(it->second, !create);
+    }
+    if (!create) return nullptr;
+
+    auto search = std::make_shared<SharedSearch>();
+    search->subscribers_ = 1;
+    live_[key] = search;
+    created = true;
+    return std::make_shared<SharedSearch::Subscription>(search, false);
+}
+
+void SearchCoalescer::remove(const ResultKey& key, const SharedSearch* search) {
+    std::lock_guard lock(mu_);
+    auto it = live_.find(key);
+    if (it != live_.end() && it->second.get() == search) live_.erase(it);
+}
+
+void SearchCoalescer::leave(SharedSearch& search, bool counted) {
+    std::lock_guard lock(mu_);
+    if (counted) followers_--;
+    if (--search.subscribers_ == 0) search.cancel_.store(true);
+}
+
+SearchCoalescer::Snapshot SearchCoalescer::snapshot() {
+    std::lock_guard lock(mu_);
+    int subscribers = 0;
+    for (const auto& [key, search] : live_) subscribers += search->subscribers_;
+    return {live_.size(), subscribers, followers_, joined_};
+}
+
+SearchCoalescer& search_coalescer() {
+    static SearchCoalescer coalescer;
+    return coalescer;
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ResultCache.h"
+#include "Search.h"
+
+// ── In-flight search coalescing ──────────────────────────────────────────────
+// Identical concurrent /search and /search-stream requests (same position, limits
+// and skill) share one running search. The first request runs it and publishes
+// each completed depth; later ones subscribe, replay the depths published so far
+// and then follow live. The search keeps running while anyone is subscribed,
+// including after the request that started it has gone, and is cancelled when
+// the last subscriber leaves.
+//
+// A follower holds an HTTP worker until the search ends but no search lane
+// permit, so followers that joined without a permit are capped process-wide
+// (max_followers, counted in the pool size); past the cap a request queues for a
+// permit like any other search and follows with the permit in hand.
+
+struct DepthEvent {
+    int depth;
+    std::string best_move;
+    int score;
+    int nodes;
+};
+
+class SharedSearch {
+public:
+    // Runner side. publish() after each completed depth; finish() exactly once.
+    void publish(DepthEvent event);
+    void finish(const SearchResult& result);
+    // Pass as SearchLimits::cancel; set once nobody is subscribed any more.
+    const std::atomic<bool>* cancel_flag() const { return &cancel_; }
+    bool cancelled() const { return cancel_.load(); }
+
+    // Subscriber side. Copies events from index next onwards into out (advancing
+    // next), first waiting up to wait_ms if there are none and the search is still
+    // running. Returns true once the search has finished, with its result in result.
+    bool wait(size_t& next, std::vector<DepthEvent>& out, SearchResult& result, int wait_ms);
+
+    // A subscription to a shared search; leaves it when destroyed.
+    class Subscription {
+    public:
+        Subscription(std::shared_ptr<SharedSearch> search, bool counted)
+            : search_(std::move(search)), counted_(counted) {}
+        ~Subscription() { leave(); }
+        Subscription(const Subscription&) = delete;
+        Subscription& operator=(const Subscription&) = delete;
+
+        SharedSearch& search() { return *search_; }
+        // Idempotent; the last subscriber to leave cancels an unfinished search.
+        void leave();
+    private:
+        std::shared_ptr<SharedSearch> search_;
+        bool counted_; // one of the capped followers
+        bool left_ = false;
+    };
+
+private:
+    friend class SearchCoalescer;
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::vector<DepthEvent> events_;
+    SearchResult result_{};
+    bool finished_ = false;
+    int subscribers_ = 0; // guarded by SearchCoalescer::mu_
+    std::atomic<bool> cancel_{false};
+};
+
+class SearchCoalescer {
+public:
+    // Subscribes to the live search for key. If there is none and create is set,
+    // registers a new one (created = true) that the caller must run and finish.
+    // Without create (a caller holding no permit) it returns nullptr when there is
+    // no live search or the follower cap is reached; with create it always follows
+    // a live search, and the caller keeps its permit while it does.
+    std::shared_ptr<SharedSearch::Subscription> join(const ResultKey& key, bool create, bool& created);
+
+    // Unregisters a finished search; a newer search under the same key is kept.
+    void remove(const ResultKey& key, const SharedSearch* search);
+
+    // Followers without a permit allowed at once. Set once at startup.
+    void set_max_followers(int max_followers) { max_followers_ = max_followers; }
+
+    struct Snapshot {
+        size_t searches;
+        int subscribers;
+        int followers;    // of those, following without a permit
+        long long joined; // requests served by an already running search
+    };
+    Snapshot snapshot();
+
+private:
+    friend class SharedSearch::Subscription;
+
+    struct KeyHash {
+        size_t operator()(const ResultKey& k) const {
+            return static_cast<size_t>((k.hash ^ (uint64_t(uint32_t(k.depth)) << 7) ^
+                                        (uint64_t(uint32_t(k.time_ms)) << 19) ^
+                                        (uint64_t(uint32_t(k.max_nodes)) << 31) ^
+                                        (uint64_t(uint32_t(k.noise)) << 51)) * 0x9E3779B97F4A7C15ULL);
+        }
+    };
+
+    void leave(SharedSearch& search, bool counted);
+
+    std::mutex mu_;
+    int max_followers_ = 16;
+    int followers_ = 0;
+    std::unordered_map<ResultKey, std::shared_ptr<SharedSearch>, KeyHash> live_;
+    long long joined_ = 0;
+};
+
+SearchCoalescer& search_coalescer();
@@ -0,0 +1,167 @@
+#include "SearchJobs.h"
+#include <cstdio>
+#include <random>
+#include <thread>
+#include "Board.h"
+#include "Metrics.h"
+#include "Move.h"
+#include "ResultCache.h"
+#include "RootSplit.h"
+#include "Search.h"
+
+const char* job_state_name(JobState state) {
+    switch (state) {
+        case JobState::DONE:      return "done";
+        case JobState::CANCELLED: return "cancelled";
+        case JobState::RUNNING:   break;
+    }
+    return "running";
+}
+
+// ============= SearchJob =============
+
+JobStatus SearchJob::status() {
+    std::lock_guard lock(mu_);
+    return status_;
+}
+
+void SearchJob::update(const JobStatus& next) {
+    std::lock_guard lock(mu_);
+    uint64_t version = status_.version + 1;
+    status_ = next;
+    status_.version = version;
+    if (next.state != JobState::RUNNING) finished_at_ = std::chrono::steady_clock::now();
+}
+
+bool SearchJob::expired(std::chrono::steady_clock::time_point now, std::chrono::milliseconds ttl) {
+    std::lock_guard lock(mu_);
+    return status_.state != JobState::RUNNING && now - finished_at_ > ttl;
+}
+
+void SearchJob::run([[maybe_unused]] std::shared_ptr<SearchLane::Permit> permit) {
+    JobStatus progress;
+
+    // Opening book: finish instantly, as /search does.
+    std::string book_move = book_lookup(params_.fen);
+    if (!book_move.empty()) {
+        progress.state = JobState::DONE;
+        progress.best_move = book_move;
+        progress.book = true;
+        update(progress);
+        return;
+    }
+
+    // The FEN was validated at submit time.
+    Board board;
+    board.setup_with_fen(params_.fen);
+
+    auto fill_pv = [&](Move best) {
+        Move line[MAX_PV_LENGTH];
+        int length = principal_variation(board, best, line, MAX_PV_LENGTH);
+        progress.pv.clear();
+        for (int i = 0; i < length; i++) progress.pv.push_back(line[i].to_uci());
+    };
+
+    DepthCallback cb = [&](int d, const std::string& best_move, int score, int nodes) -> bool {
+        progress.depth = d;
+        progress.best_move = best_move;
+        progress.score = score;
+        progress.nodes = nodes;
+        fill_pv(board.parse_uci_move(best_move));
+        update(progress);
+        return true;
+    };
+
+    SearchLimits limits;
+    limits.depth = params_.depth;
+    limits.noise = params_.noise;
+    limits.time_ms = params_.time_ms;
+    limits.max_nodes = params_.max_nodes;
+    limits.cancel = &cancel_;
+
+    ResultKey key = make_result_key(board.get_hash(), limits);
+    bool cacheable = ResultCache::cacheable(limits);
+    SearchResult result;
+    progress.cached = cacheable && result_cache().lookup(key, result);
+    if (!progress.cached) {
+        g_searches_in_flight.fetch_add(1);
+        result = split_search(board, limits, cb);
+        g_searches_in_flight.fetch_sub(1);
+        if (cacheable && !cancel_.load()) result_cache().store(key, result);
+    }
+
+    progress.state = cancel_.load() ? JobState::CANCELLED : JobState::DONE;
+    progress.depth = result.depth_completed;
+    progress.nodes = result.nodes;
+    if (result.depth_completed > 0) {
+        progress.best_move = result.best_move.to_uci();
+        progress.score = result.score;
+        fill_pv(result.best_move);
+    }
+    update(progress);
+}
+
+// ============= JobRegistry =============
+
+std::shared_ptr<SearchJob> JobRegistry::find(const std::string& id) {
+    std::lock_guard lock(mu_);
+    sweep_locked();
+    auto it = jobs_.find(id);
+    return it == jobs_.end() ? nullptr : it->second;
+}
+
+std::shared_ptr<SearchJob> JobRegistry::start(std::string id, JobParams params,
+                                              std::shared_ptr<SearchLane::Permit> permit, bool& started) {
+    std::shared_ptr<SearchJob> job;
+    {
+        std::lock_guard lock(mu_);
+        sweep_locked();
+        if (id.empty()) id = generate_id_locked();
+        auto it = jobs_.find(id);
+        if (it != jobs_.end()) {
+            started = false;
+            return it->second;
+        }
+        job = std::make_shared<SearchJob>(id, std::move(params));
+        jobs_.emplace(std::move(id), job);
+    }
+    started = true;
+    std::thread([job, permit] { job->run(permit); }).detach();
+    return job;
+}
+
+size_t JobRegistry::size() {
+    std::lock_guard lock(mu_);
+    sweep_locked();
+    return jobs_.size();
+}
+
+void JobRegistry::sweep_locked() {
+    auto now = std::chrono::steady_clock::now();
+    std::erase_if(jobs_, [&](const auto& kv) { return kv.second->expired(now, ttl_); });
+}
+
+// Unguessable enough that clients can't collide by accident; ids are not secrets.
+std::string JobRegistry::generate_id_locked() {
+    if (id_state_ == 0) id_state_ = std::random_device{}() | (uint64_t(std::random_device{}()) << 32) | 1;
+    // xorshift64*
+    id_state_ ^= id_state_ >> 12;
+    id_state_ ^= id_state_ << 25;
+    id_state_ ^= id_state_ >> 27;
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx",
+                  static_cast<unsigned long long>(id_state_ * 0x2545F4914F6CDD1DULL));
+    return buf;
+}
+
+static JobRegistry* g_search_jobs = nullptr;
+
+void init_search_jobs(int ttl_ms) {
+    // Lives for the whole process; detached job threads hold references into it.
+    g_search_jobs = new JobRegistry(ttl_ms);
+}
+
+JobRegistry& search_jobs() {
+    if (!g_search_jobs) init_search_jobs(60000);
+    return *g_search_jobs;
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "SearchLane.h"
+
+// ── Asynchronous search jobs ─────────────────────────────────────────────────
+// A job is a search detached from the HTTP request that submitted it. Clients
+// poll it for progress and fetch the result by id, so a dropped connection or a
+// caller failover doesn't lose the work: a retry submitting the same job_id
+// attaches to the running (or recently finished) search instead of starting
+// another. Finished jobs are kept for a TTL, then forgotten.
+
+enum class JobState : uint8_t {
+    RUNNING,
+    DONE,
+    CANCELLED
+};
+
+// Wire name of a job state ("running", "done", "cancelled")
+const char* job_state_name(JobState state);
+
+struct JobParams {
+    std::string fen;
+    int depth   = 4;
+    int noise   = 0;
+    int time_ms = 0;
+    int max_nodes = 0;
+
+    bool operator==(const JobParams&) const = default;
+};
+
+// Point-in-time view of a job. version increases with every update, so pollers
+// can tell whether anything changed since they last looked.
+struct JobStatus {
+    JobState state = JobState::RUNNING;
+    int depth = 0;
+    std::string best_move;
+    int score = 0;
+    int nodes = 0;
+    bool book = false;
+    bool cached = false;
+    std::vector<std::string> pv;
+    uint64_t version = 0;
+};
+
+class SearchJob {
+public:
+    SearchJob(std::string id, JobParams params) : id_(std::move(id)), params_(std::move(params)) {}
+
+    const std::string& id() const { return id_; }
+    const JobParams& params() const { return params_; }
+
+    // Stops the search at its next clock check (every 4096 nodes).
+    void cancel() { cancel_.store(true); }
+
+    JobStatus status();
+
+    // Runs the search on the calling thread; the permit is released when it returns.
+    void run(std::shared_ptr<SearchLane::Permit> permit);
+
+    bool expired(std::chrono::steady_clock::time_point now, std::chrono::milliseconds ttl);
+
+private:
+    void update(const JobStatus& next);
+
+    const std::string id_;
+    const JobParams params_;
+    std::atomic<bool> cancel_{false};
+
+    std::mutex mu_;
+    JobStatus status_;
+    std::chrono::steady_clock::time_point finished_at_;
+};
+
+class JobRegistry {
+public:
+    explicit JobRegistry(int ttl_ms) : ttl_(ttl_ms) {}
+
+    // Returns the live job with this id, or nullptr if none (or it expired).
+    std::shared_ptr<SearchJob> find(const std::string& id);
+
+    // Registers a job and starts it on its own thread, which keeps the permit.
+    // An empty id gets a generated one. If another submit registered the same id
+    // first, that job is returned instead and started is set to false.
+    std::shared_ptr<SearchJob> start(std::string id, JobParams params,
+                                     std::shared_ptr<SearchLane::Permit> permit, bool& started);
+
+    size_t size();
+
+private:
+    void sweep_locked();
+    std::string generate_id_locked();
+
+    std::chrono::milliseconds ttl_;
+    std::mutex mu_;
+    std::unordered_map<std::string, std::shared_ptr<SearchJob>> jobs_;
+    uint64_t id_state_ = 0;
+};
+
+// Process-wide registry. Configure it once at startup, before serving requests.
+void init_search_jobs(int ttl_ms);
+JobRegistry& search_jobs();
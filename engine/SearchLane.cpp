@@ -0,0 +1,93 @@
+#include "SearchLane.h"
+#include <algorithm>
+#include <chrono>
+
+Admission SearchLane::acquire(SearchPriority priority, std::shared_ptr<Permit>& out, int max_wait_ms) {
+    std::unique_lock lock(mu_);
+
+    int queued = queued_bot_ + queued_hint_;
+    bool free_slot = running_ < config_.concurrency;
+    // A hint may take a free slot only if no bot reply is waiting for it.
+    if (free_slot && (priority == SearchPriority::BOT || queued_bot_ == 0)) {
+        running_++;
+        out = std::make_shared<Permit>(*this);
+        return Admission::ADMITTED;
+    }
+
+    // Background work never makes a search wait longer than its next clock check.
+    for (auto& [permit, preempt] : background_) preempt();
+
+    if (queued >= config_.queue_depth) {
+        rejected_++;
+        return Admission::QUEUE_FULL;
+    }
+    if (priority == SearchPriority::HINT && queued * 2 >= config_.queue_depth) {
+        rejected_++;
+        return Admission::SHED;
+    }
+
+    int& waiting = priority == SearchPriority::BOT ? queued_bot_ : queued_hint_;
+    waiting++;
+    int wait_ms = max_wait_ms >= 0 ? std::min(max_wait_ms, config_.queue_timeout_ms) : config_.queue_timeout_ms;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(wait_ms);
+    bool admitted = cv_.wait_until(lock, deadline, [&] {
+        return running_ < config_.concurrency && (priority == SearchPriority::BOT || queued_bot_ == 0);
+    });
+    waiting--;
+
+    if (!admitted) {
+        rejected_++;
+        // A bot that gave up may have been the only thing holding hints back.
+        cv_.notify_all();
+        return Admission::TIMED_OUT;
+    }
+    running_++;
+    out = std::make_shared<Permit>(*this);
+    return Admission::ADMITTED;
+}
+
+bool SearchLane::try_acquire(std::shared_ptr<Permit>& out) {
+    std::lock_guard lock(mu_);
+    if (running_ >= config_.concurrency || queued_bot_ + queued_hint_ > 0) {
+        rejected_++;
+        return false;
+    }
+    running_++;
+    out = std::make_shared<Permit>(*this);
+    return true;
+}
+
+bool SearchLane::try_acquire_background(std::shared_ptr<Permit>& out, std::function<void()> preempt) {
+    std::lock_guard lock(mu_);
+    if (running_ >= config_.concurrency || queued_bot_ + queued_hint_ > 0) return false;
+    running_++;
+    out = std::make_shared<Permit>(*this);
+    background_.emplace(out.get(), std::move(preempt));
+    return true;
+}
+
+SearchLane::Snapshot SearchLane::snapshot() {
+    std::lock_guard lock(mu_);
+    return {running_, queued_bot_ + queued_hint_, rejected_, static_cast<int>(background_.size())};
+}
+
+void SearchLane::release(const Permit* permit) {
+    {
+        std::lock_guard lock(mu_);
+        running_--;
+        background_.erase(permit);
+    }
+    cv_.notify_all();
+}
+
+static SearchLane* g_search_lane = nullptr;
+
+void init_search_lane(const SearchLaneConfig& config) {
+    // Lives for the whole process; detached search threads may still hold permits at exit.
+    g_search_lane = new SearchLane(config);
+}
+
+SearchLane& search_lane() {
+    if (!g_search_lane) init_search_lane(SearchLaneConfig{});
+    return *g_search_lane;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// ── Search admission control ─────────────────────────────────────────────────
+// Searches hold a worker for seconds while /move and /stats need one for
+// microseconds. Every search must hold a permit from the search lane, which caps
+// how many run at once and how many may wait. The HTTP pool is sized so searches
+// running plus queued can never take the workers reserved for the latency lane.
+
+enum class SearchPriority : uint8_t {
+    HINT, // player-requested analysis; shed first under load
+    BOT   // bot replies in live games; always served before waiting hints
+};
+
+enum class Admission : uint8_t {
+    ADMITTED,
+    SHED,      // hint refused because the queue is already half full
+    QUEUE_FULL,
+    TIMED_OUT  // queued for longer than the lane's queue timeout
+};
+
+struct SearchLaneConfig {
+    int concurrency      = 4;    // searches running at once
+    int queue_depth      = 16;   // searches allowed to wait for a slot
+    int queue_timeout_ms = 2000; // longest a search waits before being refused
+};
+
+class SearchLane {
+public:
+    // Holds one running slot; releases it when destroyed.
+    class Permit {
+    public:
+        explicit Permit(SearchLane& lane) : lane_(lane) {}
+        ~Permit() { lane_.release(this); }
+        Permit(const Permit&) = delete;
+        Permit& operator=(const Permit&) = delete;
+    private:
+        SearchLane& lane_;
+    };
+
+    explicit SearchLane(const SearchLaneConfig& config) : config_(config) {}
+
+    // Waits for a slot up to the queue timeout, or max_wait_ms if that is set and
+    // shorter (a caller's deadline). out is set only when admitted.
+    Admission acquire(SearchPriority priority, std::shared_ptr<Permit>& out, int max_wait_ms = -1);
+
+    // Takes a slot only if one is free right now; never queues.
+    bool try_acquire(std::shared_ptr<Permit>& out);
+
+    // Like try_acquire, for background work (pondering) that must give its slot
+    // back on demand: a search that finds no free slot calls every background
+    // holder's preempt, then waits for the slots they release. preempt runs with
+    // the lane locked, so it may only signal (e.g. set a cancel flag).
+    bool try_acquire_background(std::shared_ptr<Permit>& out, std::function<void()> preempt);
+
+    const SearchLaneConfig& config() const { return config_; }
+
+    struct Snapshot {
+        int running;
+        int queued;
+        long long rejected;
+        int background; // of running, slots held by background work
+    };
+    Snapshot snapshot();
+
+private:
+    void release(const Permit* permit);
+
+    SearchLaneConfig config_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    int running_ = 0;
+    int queued_bot_ = 0;
+    int queued_hint_ = 0;
+    long long rejected_ = 0;
+    std::unordered_map<const Permit*, std::function<void()>> background_; // preempt hooks
+};
+
+// Process-wide lane shared by the HTTP and binary listeners. Configure it once at
+// startup, before any listener starts.
+void init_search_lane(const SearchLaneConfig& config);
+SearchLane& search_lane();
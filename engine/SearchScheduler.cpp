@@ -0,0 +1,156 @@
+#include "SearchScheduler.h"
+#include <algorithm>
+#include "Affinity.h"
+
+namespace {
+
+// The calling thread's search, as the scheduler sees it.
+struct Task {
+    int depth = 0;        // nested begin calls; only the outermost one schedules
+    bool holding = false; // owns a core (false once a cancel let it skip the queue)
+    int core = -1;        // which one, while holding
+    int pinned_cpu = -1;  // CPU the thread is pinned to, -1 when unpinned
+    bool timed = false;
+    std::chrono::steady_clock::time_point deadline;
+    std::chrono::steady_clock::time_point slice_start;
+    const std::atomic<bool>* cancel = nullptr;
+};
+
+thread_local Task t_task;
+
+constexpr auto CANCEL_POLL = std::chrono::milliseconds(10);
+
+} // namespace
+
+SearchScheduler::SearchScheduler(const SearchSchedulerConfig& config) : config_(config), cores_(0) {
+    set_cores(config.cores);
+}
+
+void SearchScheduler::set_cores(int cores) {
+    std::lock_guard lock(mu_);
+    int old = cores_;
+    cores_ = std::max(1, cores);
+    if (static_cast<int>(held_.size()) < cores_) held_.resize(cores_, false);
+    // Ids still held from an earlier, larger count just stop being retired.
+    for (int core = cores_ - 1; core >= old; core--) {
+        if (!held_[core]) hand_over(core);
+    }
+    std::erase_if(free_cores_, [&](int core) { return core >= cores_; });
+}
+
+SearchScheduler::Key SearchScheduler::queue_key() {
+    auto deadline = t_task.timed ? t_task.deadline
+                                 : Clock::now() + std::chrono::milliseconds(config_.untimed_horizon_ms);
+    return {deadline, next_seq_++};
+}
+
+bool SearchScheduler::wait_for_core(std::unique_lock<std::mutex>& lock, const Key& key) {
+    Waiter waiter;
+    queue_[key] = &waiter;
+    while (waiter.core < 0) {
+        if (t_task.cancel && t_task.cancel->load(std::memory_order_relaxed)) {
+            queue_.erase(key);
+            return false;
+        }
+        waiter.cv.wait_for(lock, CANCEL_POLL);
+    }
+    t_task.core = waiter.core;
+    return true;
+}
+
+void SearchScheduler::pin() {
+    if (config_.pin_cpus.empty() || !t_task.holding) return;
+    int cpu = config_.pin_cpus[t_task.core % config_.pin_cpus.size()];
+    if (cpu != t_task.pinned_cpu && pin_thread_to_cpu(cpu)) t_task.pinned_cpu = cpu;
+}
+
+void SearchScheduler::hand_over(int core) {
+    held_[core] = false;
+    if (core >= cores_) return;
+    if (queue_.empty()) {
+        free_cores_.push_back(core);
+        return;
+    }
+    held_[core] = true;
+    auto next = queue_.begin();
+    next->second->core = core;
+    next->second->cv.notify_one();
+    queue_.erase(next);
+}
+
+void SearchScheduler::begin(const SearchLimits& limits) {
+    if (t_task.depth++ > 0) return;
+    int time_ms = limits.live ? limits.live->time_ms.load(std::memory_order_relaxed) : limits.time_ms;
+    t_task.timed = time_ms > 0;
+    t_task.deadline = Clock::now() + std::chrono::milliseconds(time_ms);
+    t_task.cancel = limits.cancel;
+
+    {
+        std::unique_lock lock(mu_);
+        if (!free_cores_.empty() && queue_.empty()) {
+            t_task.core = free_cores_.back();
+            free_cores_.pop_back();
+            held_[t_task.core] = true;
+            t_task.holding = true;
+        } else {
+            t_task.holding = wait_for_core(lock, queue_key());
+        }
+    }
+    pin();
+    t_task.slice_start = Clock::now();
+}
+
+void SearchScheduler::yield() {
+    if (!t_task.holding) return;
+    auto now = Clock::now();
+    if (now - t_task.slice_start < std::chrono::milliseconds(config_.slice_ms)) return;
+    t_task.slice_start = now;
+
+    {
+        std::unique_lock lock(mu_);
+        // A retired core is given up at the next slice whoever is waiting.
+        bool retired = t_task.core >= cores_;
+        if (queue_.empty() && !retired) return;
+        Key mine = queue_key();
+        if (!retired && mine < queue_.begin()->first) return;
+        hand_over(t_task.core);
+        switches_++;
+        t_task.holding = wait_for_core(lock, mine);
+    }
+    pin();
+    t_task.slice_start = Clock::now();
+}
+
+void SearchScheduler::end() {
+    if (--t_task.depth > 0) return;
+    if (t_task.pinned_cpu >= 0) {
+        unpin_thread();
+        t_task.pinned_cpu = -1;
+    }
+    if (!t_task.holding) return;
+    t_task.holding = false;
+    std::lock_guard lock(mu_);
+    hand_over(t_task.core);
+}
+
+SearchScheduler::Snapshot SearchScheduler::snapshot() {
+    std::lock_guard lock(mu_);
+    int running = static_cast<int>(std::count(held_.begin(), held_.end(), true));
+    return {cores_, running, static_cast<int>(queue_.size()), switches_};
+}
+
+static SearchScheduler* g_search_scheduler = nullptr;
+
+void init_search_scheduler(const SearchSchedulerConfig& config) {
+    if (config.cores <= 0) return;
+    g_search_scheduler = new SearchScheduler(config);
+    SearchHooks hooks;
+    hooks.begin = [](const SearchLimits& limits) { g_search_scheduler->begin(limits); };
+    hooks.yield = [] { g_search_scheduler->yield(); };
+    hooks.end   = [] { g_search_scheduler->end(); };
+    search_set_hooks(hooks);
+}
+
+SearchScheduler* search_scheduler() {
+    return g_search_scheduler;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "Search.h"
+
+// ── Cooperative search scheduling ────────────────────────────────────────────
+// The search lane admits more searches than there are cores once the scheduler
+// is on, and each still runs on its own thread, but only `cores` of them compute
+// at any moment. The others wait, blocked, at their next clock check (every 4096
+// nodes, the SearchHooks yield point), instead of being time-sliced by the OS
+// mid-node with their killer/history tables and TT lines evicted each time.
+//
+// Which search runs next is earliest-deadline-first: a timed search's deadline is
+// its start plus time_ms, an untimed one's is "now + untimed_horizon_ms" each
+// time it queues, so analysis ages toward the front rather than starving behind a
+// stream of bot replies. A running search hands its core over at the end of its
+// slice only if a waiting one has an earlier deadline; a search whose cancel flag
+// is set stops waiting and runs unscheduled until its next clock check stops it.
+
+struct SearchSchedulerConfig {
+    int cores = 4;                   // searches computing at once; 0 disables the scheduler
+    int slice_ms = 10;               // shortest run before a search offers its core
+    int untimed_horizon_ms = 5000;   // deadline assumed for searches without time_ms
+    std::vector<int> pin_cpus;       // core k runs on pin_cpus[k % size]; empty = unpinned (Affinity.h)
+};
+
+class SearchScheduler {
+public:
+    explicit SearchScheduler(const SearchSchedulerConfig& config);
+
+    // SearchHooks entry points; run on the search's own thread.
+    void begin(const SearchLimits& limits);
+    void yield();
+    void end();
+
+    // Follows a changed CPU quota: new cores go to waiting searches at once, and
+    // cores beyond the new count are retired as their searches give them back.
+    void set_cores(int cores);
+
+    const SearchSchedulerConfig& config() const { return config_; }
+
+    struct Snapshot {
+        int cores;
+        int running;        // searches holding a core
+        int waiting;        // searches paused for one
+        long long switches; // cores handed from one search to another mid-search
+    };
+    Snapshot snapshot();
+
+private:
+    using Clock = std::chrono::steady_clock;
+    using Key = std::pair<Clock::time_point, uint64_t>; // deadline, then arrival
+    struct Waiter {
+        std::condition_variable cv;
+        int core = -1; // set when granted
+    };
+
+    // Queues the calling thread's task under key and blocks until it is handed a
+    // core (true) or its search is cancelled (false). Called with mu_ held.
+    bool wait_for_core(std::unique_lock<std::mutex>& lock, const Key& key);
+    // Pins the calling thread to its core's CPU when pinning is on.
+    void pin();
+    // Where the calling thread's task queues now.
+    Key queue_key();
+    // Gives a freed core to the queue's front, or back to the pool; retires it
+    // if it is beyond the current core count.
+    void hand_over(int core);
+
+    SearchSchedulerConfig config_;
+    std::mutex mu_;
+    int cores_;
+    std::vector<int> free_cores_;
+    std::vector<bool> held_; // by core id
+    uint64_t next_seq_ = 0;
+    std::map<Key, Waiter*> queue_; // waiting tasks, soonest first
+    long long switches_ = 0;
+};
+
+// Installs the scheduler's search hooks when config.cores > 0. Configure it once
+// at startup, before any search.
+void init_search_scheduler(const SearchSchedulerConfig& config);
+// nullptr while disabled.
+SearchScheduler* search_scheduler();
@@ -0,0 +1,265 @@
+#include "SearchSocket.h"
+#include <thread>
+#include "nlohmann/json.hpp"
+#include "Board.h"
+#include "Deadline.h"
+#include "FastJson.h"
+#include "Metrics.h"
+#include "ResultCache.h"
+#include "Search.h"
+
+static std::atomic<int> g_socket_sessions{0};
+static std::atomic<int> g_socket_searches{0};
+
+SearchSocketStats search_socket_stats() {
+    return {g_socket_sessions.load(), g_socket_searches.load()};
+}
+
+struct SearchSocketSession::Running {
+    std::string id;
+    std::string fen;
+    int noise = 0;
+    SearchPriority priority = SearchPriority::BOT;
+    LiveLimits live;
+    std::atomic<bool> cancel{false};
+    Deadline deadline;
+
+    // Guarded by the session mutex. While pondering, live runs unlimited and these
+    // hold the limits ponder-hit will switch to.
+    bool pondering = false;
+    bool limits_changed = false; // result no longer matches the start limits, so not cached
+    int depth = 4;
+    int time_ms = 0;
+    int max_nodes = 0;
+
+    // Hands the limits above to the search (none while pondering), never past the
+    // caller's deadline. Called with the session mutex held.
+    void publish(bool restart_clock) {
+        if (restart_clock) live.restart_clock();
+        auto start = std::chrono::steady_clock::time_point(
+            std::chrono::steady_clock::duration(live.clock_start.load()));
+        live.depth.store(pondering ? 64 : depth);
+        live.time_ms.store(deadline.cap_ms(pondering ? 0 : time_ms, start));
+        live.max_nodes.store(pondering ? 0 : max_nodes);
+    }
+};
+
+SearchSocketSession::SearchSocketSession(std::shared_ptr<WebSocketChannel> channel)
+    : channel_(std::move(channel)) {
+    g_socket_sessions.fetch_add(1);
+}
+
+SearchSocketSession::~SearchSocketSession() {
+    g_socket_sessions.fetch_sub(1);
+}
+
+void SearchSocketSession::send_error(std::string_view id, std::string_view error, int retry_after) {
+    std::string& buf = response_buffer();
+    JsonWriter w(buf);
+    w.begin_object().field("error", error).field("id", id);
+    if (retry_after > 0) w.field("retry_after", retry_after);
+    w.field("type", "error").end_object();
+    channel_->send(buf);
+}
+
+void SearchSocketSession::on_message(std::string_view text) {
+    nlohmann::json msg;
+    std::string id;
+    std::string type;
+    try {
+        msg = nlohmann::json::parse(text);
+        id = msg.value("id", "");
+        type = msg.value("type", "");
+    } catch (const nlohmann::json::exception&) {
+        send_error("", "invalid JSON");
+        return;
+    }
+    if (id.empty()) {
+        send_error("", "missing id");
+        return;
+    }
+
+    try {
+        if (type == "start") {
+            if (!msg.contains("fen")) {
+                send_error(id, "missing fen");
+                return;
+            }
+            auto running = std::make_shared<Running>();
+            running->id = id;
+            running->fen = msg["fen"].get<std::string>();
+            running->noise = msg.value("noise", 0);
+            running->depth = msg.value("depth", 4);
+            running->time_ms = msg.value("time_ms", 0);
+            running->max_nodes = msg.value("max_nodes", 0);
+            running->pondering = msg.value("ponder", false);
+            if (msg.value("priority", "bot") == "hint") running->priority = SearchPriority::HINT;
+            if (msg.contains("deadline_ms")) {
+                running->deadline = Deadline::from_ms(msg["deadline_ms"].get<long long>());
+                if (running->deadline.expired()) {
+                    send_error(id, "deadline exceeded");
+                    return;
+                }
+            }
+            if (running->depth < 1 || running->depth > 64) {
+                send_error(id, "depth must be 1-64");
+                return;
+            }
+            running->publish(true);
+
+            {
+                std::lock_guard lock(mu_);
+                if (closed_) return;
+                if (searches_.contains(id)) {
+                    send_error(id, "id already running");
+                    return;
+                }
+                if (searches_.size() >= MAX_SOCKET_SEARCHES) {
+                    send_error(id, "too many searches");
+                    return;
+                }
+                searches_.emplace(id, running);
+            }
+            g_socket_searches.fetch_add(1);
+            std::thread([self = shared_from_this(), running] { self->run(running); }).detach();
+            return;
+        }
+
+        std::shared_ptr<Running> running;
+        {
+            std::lock_guard lock(mu_);
+            auto it = searches_.find(id);
+            if (it != searches_.end()) running = it->second;
+        }
+        // A stop racing the result frame is harmless; the client has its answer.
+        if (!running) {
+            if (type != "stop") send_error(id, "no such search");
+            return;
+        }
+
+        if (type == "stop") {
+            running->cancel.store(true);
+        } else if (type == "change-limits") {
+            int depth = msg.value("depth", 0);
+            if (msg.contains("depth") && (depth < 1 || depth > 64)) {
+                send_error(id, "depth must be 1-64");
+                return;
+            }
+            std::lock_guard lock(mu_);
+            if (msg.contains("depth")) running->depth = depth;
+            if (msg.contains("time_ms")) running->time_ms = msg["time_ms"].get<int>();
+            if (msg.contains("max_nodes")) running->max_nodes = msg["max_nodes"].get<int>();
+            running->limits_changed = true;
+            running->publish(false);
+        } else if (type == "ponder-hit") {
+            std::lock_guard lock(mu_);
+            if (!running->pondering) return;
+            running->pondering = false;
+            running->publish(true);
+        } else {
+            send_error(id, "unknown type");
+        }
+    } catch (const nlohmann::json::exception&) {
+        send_error(id, "invalid field type");
+    }
+}
+
+void SearchSocketSession::on_close() {
+    std::lock_guard lock(mu_);
+    closed_ = true;
+    for (auto& [id, running] : searches_) running->cancel.store(true);
+}
+
+// Runs on its own thread for the life of one search.
+void SearchSocketSession::run(const std::shared_ptr<Running>& running) {
+    auto result_frame = [&](const SearchResult& r, bool book, std::string_view book_move, bool cached) {
+        std::string best_move = book ? std::string(book_move) : r.best_move.to_uci();
+        std::string& buf = response_buffer();
+        JsonWriter w(buf);
+        w.begin_object().field("best_move", best_move);
+        if (book) w.field("book", true);
+        if (cached) w.field("cached", true);
+        w.field("depth", r.depth_completed).field("id", running->id)
+         .field("nodes", r.nodes).field("score", book ? 0 : r.score);
+        if (running->cancel.load()) w.field("stopped", true);
+        w.field("type", "result").end_object();
+        channel_->send(buf);
+    };
+
+    std::shared_ptr<SearchLane::Permit> permit;
+    const Deadline& deadline = running->deadline;
+    int max_wait_ms = deadline.set ? std::max(0, deadline.budget_ms()) : -1;
+    if (search_lane().acquire(running->priority, permit, max_wait_ms) != Admission::ADMITTED) {
+        if (deadline.expired()) send_error(running->id, "deadline exceeded");
+        else send_error(running->id, "search lane busy", 1);
+        finish(running);
+        return;
+    }
+
+    SearchResult result{Move(), 0, 0, 0};
+    if (running->cancel.load()) {
+        result_frame(result, false, {}, false);
+        finish(running);
+        return;
+    }
+
+    std::string book_move = book_lookup(running->fen);
+    if (!book_move.empty()) {
+        result_frame(result, true, book_move, false);
+        finish(running);
+        return;
+    }
+
+    Board board;
+    try {
+        board.setup_with_fen(running->fen);
+    } catch (...) {
+        send_error(running->id, "failed to parse FEN");
+        finish(running);
+        return;
+    }
+
+    SearchLimits limits;
+    limits.noise = running->noise;
+    limits.cancel = &running->cancel;
+    limits.live = &running->live;
+    bool cacheable;
+    {
+        std::lock_guard lock(mu_);
+        limits.depth = running->depth;
+        limits.time_ms = running->time_ms;
+        limits.max_nodes = running->max_nodes;
+        // Results cut short by the caller's deadline aren't what these limits give.
+        cacheable = ResultCache::cacheable(limits) && !running->pondering && !running->limits_changed &&
+                    running->live.time_ms.load() == running->time_ms;
+    }
+    ResultKey key = make_result_key(board.get_hash(), limits);
+    bool cached = cacheable && result_cache().lookup(key, result);
+
+    if (!cached) {
+        DepthCallback cb = [&](int d, const std::string& best_move, int score, int nodes) -> bool {
+            std::string& buf = response_buffer();
+            JsonWriter w(buf);
+            w.begin_object().field("best_move", best_move).field("depth", d).field("id", running->id)
+             .field("nodes", nodes).field("score", score).field("type", "progress").end_object();
+            channel_->send(buf);
+            return true;
+        };
+        g_searches_in_flight.fetch_add(1);
+        result = search(board, limits, cb);
+        g_searches_in_flight.fetch_sub(1);
+
+        std::lock_guard lock(mu_);
+        if (cacheable && !running->limits_changed && !running->cancel.load()) result_cache().store(key, result);
+    }
+
+    result_frame(result, false, {}, cached);
+    finish(running);
+}
+
+void SearchSocketSession::finish(const std::shared_ptr<Running>& running) {
+    g_socket_searches.fetch_sub(1);
+    std::lock_guard lock(mu_);
+    auto it = searches_.find(running->id);
+    if (it != searches_.end() && it->second == running) searches_.erase(it);
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "EpollServer.h"
+#include "SearchLane.h"
+
+// ── WebSocket search sessions ─────────────────────────────────────────────────
+// /ws multiplexes any number of searches over one connection. Each message is a
+// JSON object with a type and the client's request id:
+//   start          fen; optional depth, noise, time_ms, max_nodes,
+//                  priority ("hint" | "bot", default bot), ponder and
+//                  deadline_ms (see Deadline.h)
+//   stop           stops the search; its result frame still follows
+//   change-limits  new depth, time_ms and/or max_nodes for a running search
+//                  (time_ms keeps counting from when the search started)
+//   ponder-hit     a search started with ponder: true switches from searching
+//                  without limits to its own, its clock starting now
+// The engine answers with frames carrying the same id:
+//   progress  after each completed depth: best_move, depth, nodes, score
+//   result    once per started search: best_move, book, cached, depth, nodes,
+//             score, and stopped when a stop or disconnect cut it short
+//   error     error text, plus retry_after when the search lane turned it away
+// Closing the socket stops every search it started.
+
+constexpr size_t MAX_SOCKET_SEARCHES = 16; // concurrent searches per connection
+
+class SearchSocketSession : public std::enable_shared_from_this<SearchSocketSession> {
+public:
+    explicit SearchSocketSession(std::shared_ptr<WebSocketChannel> channel);
+    ~SearchSocketSession();
+
+    // Both run on the event loop thread: they parse and signal, never search.
+    void on_message(std::string_view text);
+    void on_close();
+
+private:
+    struct Running;
+
+    void run(const std::shared_ptr<Running>& running);
+    void finish(const std::shared_ptr<Running>& running);
+    void send_error(std::string_view id, std::string_view error, int retry_after = 0);
+
+    std::shared_ptr<WebSocketChannel> channel_;
+    std::mutex mu_;
+    std::unordered_map<std::string, std::shared_ptr<Running>> searches_;
+    bool closed_ = false;
+};
+
+struct SearchSocketStats {
+    int sessions = 0;
+    int searches = 0;
+};
+
+SearchSocketStats search_socket_stats();
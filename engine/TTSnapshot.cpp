@@ -0,0 +1,89 @@
+#include "TTSnapshot.h"
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "Search.h"
+
+namespace {
+
+TTSnapshotConfig g_config;
+std::atomic<bool> g_enabled{false};
+std::atomic<long long> g_restored{0};
+std::atomic<uint64_t> g_saves{0};
+std::atomic<uint64_t> g_failures{0};
+std::atomic<long long> g_last_entries{0};
+std::atomic<int> g_last_save_ms{0};
+
+void save() {
+    auto start = std::chrono::steady_clock::now();
+    std::string error;
+    long long written = tt_save_snapshot(g_config.path, g_config.min_depth, error);
+    if (written < 0) {
+        g_failures.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "TT snapshot " << g_config.path << " not saved: " << error << "\n";
+        return;
+    }
+    g_saves.fetch_add(1, std::memory_order_relaxed);
+    g_last_entries.store(written, std::memory_order_relaxed);
+    g_last_save_ms.store(static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+}
+
+// Waits for a shutdown signal, saving every interval_s meanwhile. Saves run on
+// this thread only, so a signal during a periodic save waits for it to finish.
+void snapshot_loop(sigset_t signals) {
+    while (true) {
+        int sig;
+        if (g_config.interval_s > 0) {
+            timespec timeout{g_config.interval_s, 0};
+            sig = sigtimedwait(&signals, nullptr, &timeout);
+            if (sig < 0) {
+                if (errno == EAGAIN) save();
+                continue;
+            }
+        } else if (sigwait(&signals, &sig) != 0) {
+            continue;
+        }
+        save();
+        std::cout << "TT snapshot: " << g_last_entries.load() << " entries saved, exiting on signal "
+                  << sig << "\n";
+        std::cout.flush();
+        _exit(0);
+    }
+}
+
+} // namespace
+
+void start_tt_snapshots(const TTSnapshotConfig& config) {
+    if (config.path.empty()) return;
+    g_config = config;
+    g_enabled.store(true);
+
+    std::string error;
+    long long restored = tt_load_snapshot(config.path, error);
+    if (restored >= 0) {
+        g_restored.store(restored);
+        std::cout << "TT snapshot " << config.path << ": restored " << restored << " entries\n";
+    } else if (access(config.path.c_str(), F_OK) == 0) {
+        std::cerr << "TT snapshot " << config.path << " ignored: " << error << "\n";
+    }
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::thread(snapshot_loop, signals).detach();
+}
+
+TTSnapshotStats tt_snapshot_stats() {
+    return {g_enabled.load(), g_restored.load(), g_saves.load(), g_failures.load(),
+            g_last_entries.load(), g_last_save_ms.load()};
+}
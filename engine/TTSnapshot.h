@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// ============= TT Snapshots =============
+//
+// A replacement replica normally starts with an empty TT, so its first searches
+// are shallower and weaker than the ones it replaces. With a snapshot path set
+// the engine restores the table from that file at startup, rewrites it every
+// interval_s and once more on SIGTERM/SIGINT before exiting, keeping only entries
+// at least min_depth deep (the ones worth a restart; see tt_save_snapshot for the
+// file format). The path should be on a volume that survives the container.
+
+struct TTSnapshotConfig {
+    std::string path;     // empty disables snapshots
+    int min_depth = 6;    // shallowest entry worth keeping
+    int interval_s = 300; // between periodic saves; 0 saves only on shutdown
+};
+
+// Restores the snapshot (a missing file is not an error), then starts the thread
+// that saves periodically and on shutdown signals. Call at the top of main after
+// the TT is set up and before any other thread starts: the signals are blocked
+// in the calling thread so that every thread created later inherits the mask and
+// only the snapshot thread receives them.
+void start_tt_snapshots(const TTSnapshotConfig& config);
+
+struct TTSnapshotStats {
+    bool enabled = false;
+    long long restored = 0;     // entries merged from the snapshot at startup
+    uint64_t saves = 0;
+    uint64_t failures = 0;
+    long long last_entries = 0; // entries in the last snapshot written
+    int last_save_ms = 0;
+};
+
+TTSnapshotStats tt_snapshot_stats();
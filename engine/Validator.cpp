@@ -1,40 +1,139 @@
 #include "Validator.h"
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
 #include "Board.h"
 #include "Move.h"
 
+// Below this many pairs per thread, spawning threads costs more than it saves.
+static constexpr size_t MIN_PAIRS_PER_THREAD = 64;
 
-std::string process_move(const std::string& current_fen, const std::string& uci_move) {
+// Board::history holds 256 plies; long sequences re-root the board before that.
+static constexpr int REROOT_PLIES = 200;
+
+
+const char* game_state_name(GameState state) {
+    switch (state) {
+        case GameState::CHECKMATE:         return "CHECKMATE";
+        case GameState::STALEMATE:         return "STALEMATE";
+        case GameState::DRAW_50_MOVE:      return "DRAW_50_MOVE";
+        case GameState::DRAW_INSUFFICIENT: return "DRAW_INSUFFICIENT";
+        case GameState::ACTIVE:            break;
+    }
+    return "ACTIVE";
+}
+
+GameState classify_game_state(Board& board) {
+    Move legal_moves[256];
+    int legal_count = board.get_legal_moves(legal_moves);
+    bool in_check = board.is_in_check(board.get_player_to_move());
+
+    if (legal_count == 0 && in_check) {
+        return GameState::CHECKMATE;
+    } else if (legal_count == 0 && !in_check) {
+        return GameState::STALEMATE;
+    } else if (board.get_halfmove_clock() >= 100) {
+        return GameState::DRAW_50_MOVE;
+    } else if (board.is_insufficient_material()) {
+        return GameState::DRAW_INSUFFICIENT;
+    }
+    return GameState::ACTIVE;
+}
+
+bool validate_move(std::string_view current_fen, std::string_view uci_move, MoveOutcome& out) {
     Board board;
     try {
-        board.setup_with_fen(current_fen);
+        board.setup_with_fen(std::string(current_fen));
     } catch (...) {
-        return "SYSTEM_ERROR";
+        return false;
     }
 
+    out.valid = false;
+    out.new_fen_length = 0;
+
     Move m = board.parse_uci_move(uci_move);
 
     if (m == Move()) {
-        return "{\"status\": \"INVALID\"}";
+        return true;
     }
 
     board.move(m);
 
-    Move legal_moves[256];
-    int legal_count = board.get_legal_moves(legal_moves);
-    bool in_check = board.is_in_check(board.get_player_to_move());
+    out.game_state = classify_game_state(board);
+    out.valid = true;
+    out.new_fen_length = board.write_fen(out.new_fen);
+    return true;
+}
 
-    std::string game_state;
-    if (legal_count == 0 && in_check) {
-        game_state = "CHECKMATE";
-    } else if (legal_count == 0 && !in_check) {
-        game_state = "STALEMATE";
-    } else if (board.get_halfmove_clock() >= 100) {
-        game_state = "DRAW_50_MOVE";
-    } else if (board.is_insufficient_material()) {
-        game_state = "DRAW_INSUFFICIENT";
-    } else {
-        game_state = "ACTIVE";
+void validate_pairs(std::span<const MovePair> pairs, std::span<PairOutcome> out, unsigned max_threads) {
+    auto run = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            out[i].parsed = validate_move(pairs[i].fen, pairs[i].uci_move, out[i].move);
+        }
+    };
+
+    size_t threads = std::min<size_t>(std::max(max_threads, 1u),
+                                      (pairs.size() + MIN_PAIRS_PER_THREAD - 1) / MIN_PAIRS_PER_THREAD);
+    if (threads <= 1) {
+        run(0, pairs.size());
+        return;
+    }
+
+    // The calling thread takes the first chunk.
+    size_t chunk = (pairs.size() + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t begin = chunk; begin < pairs.size(); begin += chunk) {
+        workers.emplace_back(run, begin, std::min(begin + chunk, pairs.size()));
+    }
+    run(0, std::min(chunk, pairs.size()));
+    for (auto& t : workers) t.join();
+}
+
+int validate_sequence(std::string_view start_fen, std::span<const std::string_view> moves,
+                      std::span<MoveOutcome> out) {
+    auto board = std::make_unique<Board>();
+    try {
+        board->setup_with_fen(std::string(start_fen));
+    } catch (...) {
+        return -1;
+    }
+
+    int plies = 0;
+    for (size_t i = 0; i < moves.size(); i++) {
+        MoveOutcome& o = out[i];
+        o.valid = false;
+        o.new_fen_length = 0;
+
+        Move m = board->parse_uci_move(moves[i]);
+        if (m == Move()) return static_cast<int>(i + 1);
+
+        board->move(m);
+        if (++plies >= REROOT_PLIES) {
+            PackedPosition packed = board->pack();
+            board = std::make_unique<Board>();
+            board->setup_with_packed(packed);
+            plies = 0;
+        }
+
+        o.game_state = classify_game_state(*board);
+        o.valid = true;
+        o.new_fen_length = board->write_fen(o.new_fen);
+    }
+    return static_cast<int>(moves.size());
+}
+
+std::string process_move(const std::string& current_fen, const std::string& uci_move) {
+    MoveOutcome outcome;
+    if (!validate_move(current_fen, uci_move, outcome)) {
+        return "SYSTEM_ERROR";
+    }
+
+    if (!outcome.valid) {
+        return "{\"status\": \"INVALID\"}";
     }
 
-    return "{\"status\": \"VALID\", \"game_state\": \"" + game_state + "\", \"new_fen\": \"" + board.to_fen() + "\"}";
+    return "{\"status\": \"VALID\", \"game_state\": \"" + std::string(game_state_name(outcome.game_state)) +
+           "\", \"new_fen\": \"" + std::string(outcome.fen()) + "\"}";
 }
@@ -1,5 +1,60 @@
 #pragma once
+#include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
+#include "Board.h"
+
+enum class GameState : uint8_t {
+    ACTIVE,
+    CHECKMATE,
+    STALEMATE,
+    DRAW_50_MOVE,
+    DRAW_INSUFFICIENT
+};
+
+// Wire name of a game state ("ACTIVE", "CHECKMATE", ...)
+const char* game_state_name(GameState state);
+
+// Classifies the position on the board after a move has been made.
+GameState classify_game_state(Board& board);
+
+// Result of applying a UCI move to a position. new_fen is only set for valid moves.
+struct MoveOutcome {
+    bool valid = false;
+    GameState game_state = GameState::ACTIVE;
+    char new_fen[FEN_MAX_LENGTH];
+    size_t new_fen_length = 0;
+
+    std::string_view fen() const { return {new_fen, new_fen_length}; }
+};
+
+// Validates uci_move against current_fen without building any strings.
+// Returns false if the FEN could not be parsed.
+bool validate_move(std::string_view current_fen, std::string_view uci_move, MoveOutcome& out);
+
+// One independent (fen, uci_move) entry of a batch.
+struct MovePair {
+    std::string_view fen;
+    std::string_view uci_move;
+};
+
+// Result of one batch entry. parsed is false when the entry's FEN was rejected.
+struct PairOutcome {
+    bool parsed = false;
+    MoveOutcome move;
+};
+
+// Validates independent pairs, split across up to max_threads threads.
+// out must be the same size as pairs.
+void validate_pairs(std::span<const MovePair> pairs, std::span<PairOutcome> out, unsigned max_threads);
+
+// Plays moves in order on one board set up from start_fen, so the FEN is parsed once
+// rather than once per ply. Stops at the first illegal move, whose outcome has
+// valid == false. Returns the number of outcomes written, or -1 if start_fen could
+// not be parsed. out must be at least as large as moves.
+int validate_sequence(std::string_view start_fen, std::span<const std::string_view> moves,
+                      std::span<MoveOutcome> out);
 
 // Takes a FEN and a UCI move, returns the JSON output string
 std::string process_move(const std::string& current_fen, const std::string& uci_move);
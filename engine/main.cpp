@@ -1,94 +1,604 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <ctime>
 #include <atomic>
+#include <memory>
 #include <thread>
-#include <chrono>
 #include <unistd.h>
 #include "httplib.h"
 #include "nlohmann/json.hpp"
+#include "Affinity.h"
+#include "BinaryServer.h"
+#include "Cgroup.h"
+#include "Deadline.h"
+#include "DistributedTT.h"
+#include "EpollServer.h"
+#include "FastJson.h"
+#include "GameSessions.h"
+#include "LoadReport.h"
+#include "MemoryGovernor.h"
+#include "Metrics.h"
+#include "Overload.h"
+#include "Ponder.h"
 #include "Validator.h"
+#include "ResultCache.h"
+#include "RootSplit.h"
 #include "Search.h"
+#include "SearchCoalescer.h"
+#include "SearchJobs.h"
+#include "SearchLane.h"
+#include "SearchScheduler.h"
+#include "SearchSocket.h"
+#include "TTSnapshot.h"
 
-// ── Engine-wide metrics ───────────────────────────────────────────────────────
-static std::atomic<int>    g_searches_in_flight{0};
-// cpu_percent stored as integer * 10 (e.g. 753 = 75.3%) for atomic portability
-static std::atomic<int>    g_cpu_percent_x10{0};
-
-static long long read_cpu_ticks() {
-    std::ifstream f("/proc/self/stat");
-    if (!f.is_open()) return -1;
-    std::string line;
-    std::getline(f, line);
-    std::istringstream ss(line);
-    std::string tok;
-    // fields are 1-indexed; utime=14, stime=15
-    for (int i = 1; i <= 13; i++) ss >> tok;
-    long long utime = 0, stime = 0;
-    ss >> utime >> stime;
-    return utime + stime;
+// ── Response serialization ───────────────────────────────────────────────────
+// Bodies are written into the per-thread response buffer. Keys are emitted in
+// alphabetical order to match the nlohmann output these endpoints always sent.
+
+struct SearchReport {
+    std::string_view best_move;
+    int score   = 0;
+    int depth   = 0;
+    int nodes   = 0;
+    bool book   = false;
+    bool cached = false; // answered from the result cache
+    bool degraded = false; // overload mode: TT answer or shrunk budget
+    bool done   = false; // SSE only: final event of a stream
+    int time_ms = 0;     // /search echoes its time budget when one was set
+};
+
+static void write_search_report(JsonWriter& w, const SearchReport& r) {
+    w.begin_object().field("best_move", r.best_move);
+    if (r.book) w.field("book", true);
+    if (r.cached) w.field("cached", true);
+    if (r.degraded) w.field("degraded", true);
+    w.field("depth", r.depth);
+    if (r.done) w.field("done", true);
+    w.field("nodes", r.nodes).field("score", r.score);
+    if (r.time_ms > 0) w.field("time_ms", r.time_ms);
+    w.end_object();
 }
 
-static void track_cpu() {
-    long long prev = read_cpu_ticks();
-    auto prev_t = std::chrono::steady_clock::now();
-    while (true) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-        long long cur = read_cpu_ticks();
-        auto cur_t    = std::chrono::steady_clock::now();
-        if (prev >= 0 && cur >= 0) {
-            double elapsed = std::chrono::duration<double>(cur_t - prev_t).count();
-            int cores = std::max(1, (int)std::thread::hardware_concurrency());
-            double pct = (cur - prev) / (elapsed * 100.0 * cores) * 100.0;
-            if (pct > 100.0) pct = 100.0;
-            if (pct < 0.0)   pct = 0.0;
-            g_cpu_percent_x10.store(static_cast<int>(pct * 10));
-        }
-        prev = cur;
-        prev_t = cur_t;
+static std::string& search_json(const SearchReport& r) {
+    std::string& buf = response_buffer();
+    JsonWriter w(buf);
+    write_search_report(w, r);
+    return buf;
+}
+
+static std::string& search_event(const SearchReport& r) {
+    std::string& buf = response_buffer();
+    buf += "data: ";
+    JsonWriter w(buf);
+    write_search_report(w, r);
+    buf += "\n\n";
+    return buf;
+}
+
+// Outcome of a /move-and-reply turn. The reply fields are only written when the
+// human move left the game active; bot fields only when a reply was found.
+struct TurnReport {
+    std::string_view new_fen;
+    GameState game_state = GameState::ACTIVE;
+    bool searched = false;          // a reply was looked up (book or search)
+    std::string_view best_move;     // empty if no reply was found
+    bool book = false;
+    bool cached = false;
+    bool degraded = false;
+    PonderOutcome ponder = PonderOutcome::NONE; // session games: was the human move expected
+    std::string_view bot_fen;
+    GameState bot_game_state = GameState::ACTIVE;
+    int depth = 0;
+    int nodes = 0;
+    int score = 0;
+    const char* error = nullptr;    // the reply was refused a search (see refusal())
+    int retry_after = 0;            // seconds, with error when retrying may help
+};
+
+static std::string& turn_event(const TurnReport& r) {
+    std::string& buf = response_buffer();
+    buf += "data: ";
+    JsonWriter w(buf);
+    bool has_reply = !r.best_move.empty();
+    w.begin_object();
+    if (has_reply) w.field("best_move", r.best_move);
+    if (r.book) w.field("book", true);
+    if (has_reply) {
+        w.field("bot_fen", r.bot_fen)
+         .field("bot_game_state", game_state_name(r.bot_game_state));
     }
+    if (r.cached) w.field("cached", true);
+    if (r.degraded) w.field("degraded", true);
+    if (r.searched) w.field("depth", r.depth);
+    w.field("done", true);
+    if (r.error) w.field("error", r.error);
+    w.field("game_state", game_state_name(r.game_state))
+     .field("new_fen", r.new_fen);
+    if (r.searched) w.field("nodes", r.nodes);
+    if (r.ponder != PonderOutcome::NONE) w.field("ponder", ponder_outcome_name(r.ponder));
+    if (r.retry_after > 0) w.field("retry_after", r.retry_after);
+    if (r.searched) w.field("score", r.score);
+    w.field("status", "VALID").end_object();
+    buf += "\n\n";
+    return buf;
 }
 
-int main() {
-    std::srand(static_cast<unsigned>(std::time(nullptr)));
-    std::thread(track_cpu).detach();
+// Upper bound on entries in one /move-batch request.
+static constexpr size_t MAX_BATCH_MOVES = 1024;
+// Pairs validated per SSE flush when a batch is streamed.
+static constexpr size_t BATCH_STREAM_CHUNK = 256;
 
-    httplib::Server svr;
-    // Default thread pool is max(8, hardware_concurrency-1) which queues under
-    // burst load. 32 threads per replica handles concurrent move validation
-    // without timeouts at high VU counts.
-    svr.new_task_queue = [] { return new httplib::ThreadPool(32); };
+// One /move-batch result, shaped like a /move response. index is only written
+// when streaming, where it ties each event back to its request entry.
+static void write_batch_entry(JsonWriter& w, bool parsed, const MoveOutcome& o, int index = -1) {
+    w.begin_object();
+    if (!parsed) w.field("error", "failed to parse FEN");
+    if (parsed && o.valid) w.field("game_state", game_state_name(o.game_state));
+    if (index >= 0) w.field("index", index);
+    if (parsed && o.valid) w.field("new_fen", o.fen());
+    w.field("status", !parsed ? "ERROR" : o.valid ? "VALID" : "INVALID");
+    w.end_object();
+}
+
+// Job status as returned by every /jobs endpoint.
+static std::string& job_json(const std::string& id, const JobStatus& st) {
+    std::string& buf = response_buffer();
+    JsonWriter w(buf);
+    w.begin_object().field("best_move", st.best_move);
+    if (st.book) w.field("book", true);
+    if (st.cached) w.field("cached", true);
+    w.field("depth", st.depth)
+     .field("job_id", id)
+     .field("nodes", st.nodes)
+     .key("pv").begin_array();
+    for (const std::string& m : st.pv) w.value(m);
+    w.end_array()
+     .field("score", st.score)
+     .field("state", job_state_name(st.state))
+     .field("version", static_cast<long long>(st.version))
+     .end_object();
+    return buf;
+}
+
+// Client-chosen job ids: 1-64 characters of [A-Za-z0-9_-].
+static bool valid_job_id(std::string_view id) {
+    if (id.empty() || id.size() > 64) return false;
+    for (char c : id) {
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                  c == '_' || c == '-';
+        if (!ok) return false;
+    }
+    return true;
+}
+
+// Streams a coalesced search that another request is running: the depths it has
+// published so far, then live ones, then the final event. permit, if the request
+// took one before finding the search, is held until the stream ends.
+static void stream_shared_search(httplib::Response& res, std::shared_ptr<SharedSearch::Subscription> sub,
+                                 std::shared_ptr<SearchLane::Permit> permit) {
+    res.set_chunked_content_provider("text/event-stream",
+        [sub, permit](size_t /*offset*/, httplib::DataSink& sink) {
+            SharedSearch& shared = sub->search();
+            size_t next = 0;
+            std::vector<DepthEvent> events;
+            SearchResult result;
+            while (true) {
+                // Wake periodically to notice a disconnected client.
+                bool finished = shared.wait(next, events, result, 250);
+                if (!sink.is_writable()) {
+                    sub->leave();
+                    return false;
+                }
+                for (const DepthEvent& ev : events) {
+                    std::string& line = search_event({.best_move = ev.best_move, .score = ev.score,
+                                                      .depth = ev.depth, .nodes = ev.nodes});
+                    sink.write(line.data(), line.size());
+                }
+                if (finished) break;
+            }
+
+            std::string best_move = result.best_move.to_uci();
+            std::string& line = search_event({.best_move = best_move, .score = result.score,
+                                              .depth = result.depth_completed, .nodes = result.nodes,
+                                              .done = true});
+            sink.write(line.data(), line.size());
+            sink.done();
+            sub->leave();
+            return false;
+        });
+}
+
+// This replica's routing identity (see /route-info): ENGINE_REPLICA_ID, or the
+// hostname, which Docker keeps for the container's lifetime. Set in main.
+static std::string g_replica_id;
+
+// ENGINE_TT_NUMA as applied, or empty when the TT keeps the default placement.
+static std::string g_tt_numa;
+
+// Reads an integer setting from the environment, falling back to def when unset.
+static int env_int(const char* name, int def) {
+    const char* v = std::getenv(name);
+    return (v && *v) ? std::atoi(v) : def;
+}
+
+// Reads the caller's X-Deadline-Ms (see Deadline.h). A request whose budget is
+// already spent gets a 504 before its body is parsed.
+static bool read_deadline(const httplib::Request& req, httplib::Response& res, Deadline& deadline) {
+    deadline = Deadline::parse(req.get_header_value("X-Deadline-Ms"));
+    if (!deadline.expired()) return true;
+    res.status = 504;
+    res.set_content(R"({"error":"deadline exceeded"})", "application/json");
+    return false;
+}
+
+// Takes a search lane permit for this request. Callers pass X-Search-Priority:
+// hint|bot; def applies when the header is absent. The wait never outlasts the
+// caller's deadline. Either way the response carries X-Engine-Load
+// (LoadReport.h) for the router.
+static Admission acquire_search(const httplib::Request& req, httplib::Response& res, SearchPriority def,
+                                const Deadline& deadline, std::shared_ptr<SearchLane::Permit>& permit) {
+    SearchPriority priority = def;
+    std::string header = req.get_header_value("X-Search-Priority");
+    if (header == "hint") priority = SearchPriority::HINT;
+    else if (header == "bot") priority = SearchPriority::BOT;
+
+    int max_wait_ms = deadline.set ? std::max(0, deadline.budget_ms()) : -1;
+    Admission admission = search_lane().acquire(priority, permit, max_wait_ms);
+    res.set_header("X-Engine-Load", load_header(load_report()));
+    return admission;
+}
+
+// Why a refused search was refused: 504 once the caller's deadline is spent,
+// else 429 for shed hints and 503 for a full or stalled queue (both retryable
+// after Retry-After).
+struct Refusal {
+    int status;
+    const char* error;
+};
+
+static Refusal refusal(Admission admission, const Deadline& deadline) {
+    if (admission == Admission::SHED) return {429, "search lane busy"};
+    if (deadline.expired()) return {504, "deadline exceeded"};
+    return {503, "search lane full"};
+}
+
+// acquire_search, filling in the rejection when refused.
+static bool admit_search(const httplib::Request& req, httplib::Response& res, SearchPriority def,
+                         const Deadline& deadline, std::shared_ptr<SearchLane::Permit>& permit) {
+    Admission admission = acquire_search(req, res, def, deadline, permit);
+    if (admission == Admission::ADMITTED) return true;
+    Refusal refused = refusal(admission, deadline);
+    res.status = refused.status;
+    if (refused.status != 504) res.set_header("Retry-After", "1");
+    std::string& buf = response_buffer();
+    JsonWriter(buf).begin_object().field("error", refused.error).end_object();
+    res.set_content(buf.data(), buf.size(), "application/json");
+    return false;
+}
 
+// Result-cache lookup, then overload mode (see Overload.h) when the engine is
+// overloaded: a TT answer, or shrunk limits with key recomputed so the cheaper
+// search is what gets cached and coalesced. Returns true if result holds the answer.
+static bool answer_without_search(Board& board, SearchLimits& limits, ResultKey& key,
+                                  SearchResult& result, bool& cached, bool& degraded) {
+    // Cached results were searched without game history, so a game with pre-root
+    // positions (a repetition draw waiting to happen) never takes one.
+    bool lookup = ResultCache::cacheable(limits) && limits.game_hash_count == 0;
+    cached = lookup && result_cache().lookup(key, result);
+    degraded = false;
+    if (cached || !overload().active()) return cached;
+
+    degraded = true;
+    if (overload().degrade(board, limits, result)) return true;
+    key = make_result_key(board.get_hash(), limits);
+    cached = lookup && result_cache().lookup(key, result);
+    return cached;
+}
+
+// Every HTTP route, registered on whichever server main() picks. Both httplib::Server
+// and EpollServer take the same (Request, Response) handlers.
+template <typename Server>
+static void register_routes(Server& svr) {
     svr.Post("/move", [](const httplib::Request& req, httplib::Response& res) {
-        nlohmann::json body;
-        try {
-            body = nlohmann::json::parse(req.body);
-        } catch (const nlohmann::json::parse_error&) {
+        Deadline deadline;
+        if (!read_deadline(req, res, deadline)) return;
+        EngineRequest body;
+        switch (parse_move_request(req.body, body)) {
+            case ParseStatus::INVALID_JSON:
+                res.status = 400;
+                res.set_content(R"({"error":"invalid JSON"})", "application/json");
+                return;
+            case ParseStatus::MISSING_FIELD:
+                res.status = 400;
+                res.set_content(R"({"error":"missing fen or uci_move"})", "application/json");
+                return;
+            case ParseStatus::OK:
+                break;
+        }
+
+        MoveOutcome outcome;
+        if (!validate_move(body.fen, body.uci_move, outcome)) {
             res.status = 400;
-            res.set_content(R"({"error":"invalid JSON"})", "application/json");
+            res.set_content(R"({"error":"failed to parse FEN"})", "application/json");
             return;
         }
 
-        if (!body.contains("fen") || !body.contains("uci_move")) {
+        std::string& buf = response_buffer();
+        JsonWriter w(buf);
+        w.begin_object().field("status", outcome.valid ? "VALID" : "INVALID");
+        if (outcome.valid) {
+            w.field("game_state", game_state_name(outcome.game_state))
+             .field("new_fen", outcome.fen());
+        }
+        w.end_object();
+        res.set_content(buf.data(), buf.size(), "application/json");
+    });
+
+    // Batch validation for imports, replays and re-checks. Accepts either
+    //   {"pairs":[{"fen":...,"uci_move":...},...]}  independent, validated in parallel
+    //   {"fen":...,"uci_moves":[...]}               one game, played on a single board
+    // and answers {"results":[...]} with one /move-shaped entry per input, or SSE
+    // events carrying an index when "stream":true, then {"count":n,"done":true}.
+    // A sequence stops at its first illegal move. A pair with a bad FEN gets
+    // {"error":...,"status":"ERROR"}; a bad sequence start FEN fails the request.
+    svr.Post("/move-batch", [](const httplib::Request& req, httplib::Response& res) {
+        Deadline deadline;
+        if (!read_deadline(req, res, deadline)) return;
+        auto batch = std::make_shared<BatchRequest>();
+        switch (parse_batch_request(req.body, *batch)) {
+            case ParseStatus::INVALID_JSON:
+                res.status = 400;
+                res.set_content(R"({"error":"invalid JSON"})", "application/json");
+                return;
+            case ParseStatus::MISSING_FIELD:
+                res.status = 400;
+                res.set_content(R"({"error":"missing pairs, or fen and uci_moves"})", "application/json");
+                return;
+            case ParseStatus::OK:
+                break;
+        }
+
+        if (batch->uci_moves.size() > MAX_BATCH_MOVES) {
             res.status = 400;
-            res.set_content(R"({"error":"missing fen or uci_move"})", "application/json");
+            res.set_content(R"({"error":"batch exceeds 1024 moves"})", "application/json");
+            return;
+        }
+
+        size_t n = batch->uci_moves.size();
+        unsigned threads = static_cast<unsigned>(std::ceil(g_cpu_capacity_x100.load() / 100.0));
+
+        // Sequences are cheap to replay on one board; run them up front so a bad
+        // start FEN can still be reported with a 400.
+        auto sequence = std::make_shared<std::vector<MoveOutcome>>();
+        int played = 0;
+        if (batch->sequence) {
+            std::vector<std::string_view> moves(batch->uci_moves.begin(), batch->uci_moves.end());
+            sequence->resize(n);
+            played = validate_sequence(batch->fen, moves, *sequence);
+            if (played < 0) {
+                res.status = 400;
+                res.set_content(R"({"error":"failed to parse FEN"})", "application/json");
+                return;
+            }
+            sequence->resize(played);
+        }
+
+        if (batch->stream) {
+            res.set_chunked_content_provider("text/event-stream",
+                [batch, sequence, threads](size_t /*offset*/, httplib::DataSink& sink) {
+                    size_t count = batch->sequence ? sequence->size() : batch->uci_moves.size();
+                    std::vector<MovePair> pairs;
+                    std::vector<PairOutcome> chunk_out;
+                    for (size_t begin = 0; begin < count; begin += BATCH_STREAM_CHUNK) {
+                        if (!sink.is_writable()) return false;
+                        size_t end = std::min(begin + BATCH_STREAM_CHUNK, count);
+
+                        if (!batch->sequence) {
+                            pairs.clear();
+                            for (size_t i = begin; i < end; i++) {
+                                pairs.push_back({batch->fens[i], batch->uci_moves[i]});
+                            }
+                            chunk_out.assign(pairs.size(), PairOutcome{});
+                            validate_pairs(pairs, chunk_out, threads);
+                        }
+
+                        std::string& buf = response_buffer();
+                        for (size_t i = begin; i < end; i++) {
+                            buf += "data: ";
+                            JsonWriter w(buf);
+                            if (batch->sequence) {
+                                write_batch_entry(w, true, (*sequence)[i], static_cast<int>(i));
+                            } else {
+                                const PairOutcome& o = chunk_out[i - begin];
+                                write_batch_entry(w, o.parsed, o.move, static_cast<int>(i));
+                            }
+                            buf += "\n\n";
+                        }
+                        sink.write(buf.data(), buf.size());
+                    }
+
+                    std::string& line = response_buffer();
+                    line += "data: ";
+                    JsonWriter(line).begin_object()
+                        .field("count", static_cast<long long>(count))
+                        .field("done", true)
+                        .end_object();
+                    line += "\n\n";
+                    sink.write(line.data(), line.size());
+                    sink.done();
+                    return false;
+                });
             return;
         }
 
-        std::string fen      = body["fen"].get<std::string>();
-        std::string uci_move = body["uci_move"].get<std::string>();
+        std::vector<PairOutcome> outcomes;
+        if (!batch->sequence) {
+            std::vector<MovePair> pairs;
+            pairs.reserve(n);
+            for (size_t i = 0; i < n; i++) pairs.push_back({batch->fens[i], batch->uci_moves[i]});
+            outcomes.resize(n);
+            validate_pairs(pairs, outcomes, threads);
+        }
+
+        std::string& buf = response_buffer();
+        JsonWriter w(buf);
+        w.begin_object().key("results").begin_array();
+        if (batch->sequence) {
+            for (const MoveOutcome& o : *sequence) write_batch_entry(w, true, o);
+        } else {
+            for (const PairOutcome& o : outcomes) write_batch_entry(w, o.parsed, o.move);
+        }
+        w.end_array().end_object();
+        res.set_content(buf.data(), buf.size(), "application/json");
+    });
+
+    // Routing identity for callers that pin each game to one replica so its TT,
+    // session and ponder search stay warm (consistent hashing in the Go backend).
+    // replica_id is stable for the life of the replica; capacity is how many
+    // searches it runs at once, which callers use as its weight on the ring.
+    svr.Get("/route-info", [](const httplib::Request& /*req*/, httplib::Response& res) {
+        std::string& buf = response_buffer();
+        JsonWriter(buf).begin_object()
+            .field("capacity", search_lane().config().concurrency)
+            .field("replica_id", g_replica_id)
+            .field("sessions", static_cast<int>(game_sessions().snapshot().sessions))
+            .end_object();
+        res.set_content(buf.data(), buf.size(), "application/json");
+    });
 
-        std::string result = process_move(fen, uci_move);
+    // Full load report (LoadReport.h), for routers choosing the least-loaded replica.
+    svr.Get("/load", [](const httplib::Request& /*req*/, httplib::Response& res) {
+        LoadReport load = load_report();
+        std::string& buf = response_buffer();
+        JsonWriter w(buf);
+        w.begin_object().key("active_searches").begin_array();
+        for (const ActiveSearch& s : load.searches) {
+            w.begin_object()
+                .field("depth", s.depth)
+                .field("elapsed_ms", s.elapsed_ms)
+                .field("max_nodes", s.max_nodes)
+                .field("remaining_ms", s.time_ms > 0 ? std::max(0, s.time_ms - s.elapsed_ms) : -1)
+                .end_object();
+        }
+        w.end_array()
+            .field("estimated_wait_ms", load.estimated_wait_ms)
+            .field("health", load.health)
+            .key("lanes").begin_object()
+                .key("scheduler").begin_object()
+                    .field("cores", load.cores)
+                    .field("waiting", load.core_waiting)
+                .end_object()
+                .key("search").begin_object()
+                    .field("background", load.background)
+                    .field("concurrency", load.concurrency)
+                    .field("queue_depth", load.queue_depth)
+                    .field("queued", load.queued)
+                    .field("running", load.running)
+                .end_object()
+            .end_object()
+            .field("recent_search_ms", load.recent_search_ms)
+            .field("replica_id", g_replica_id)
+            .end_object();
+        res.set_header("Cache-Control", "no-cache");
+        res.set_content(buf.data(), buf.size(), "application/json");
+    });
 
-        if (result == "SYSTEM_ERROR") {
+    // Peer half of root splitting (RootSplit.h): searches the given root moves of
+    // fen to depth inside [alpha, beta] and answers {"nodes","scores"} with scores
+    // for the leading moves that finished in time. Takes a search lane permit like
+    // any bot search; the coordinator treats a rejection as a dead peer.
+    svr.Post("/search-moves", [](const httplib::Request& req, httplib::Response& res) {
+        Deadline deadline;
+        if (!read_deadline(req, res, deadline)) return;
+        SearchLimits limits;
+        std::vector<uint64_t> game_hashes;
+        std::vector<std::string> uci_moves;
+        std::string fen;
+        int depth, alpha, beta;
+        try {
+            auto j = nlohmann::json::parse(req.body);
+            fen         = j.at("fen").get<std::string>();
+            uci_moves   = j.at("moves").get<std::vector<std::string>>();
+            depth       = j.at("depth").get<int>();
+            alpha       = j.at("alpha").get<int>();
+            beta        = j.at("beta").get<int>();
+            limits.noise   = j.value("noise", 0);
+            limits.time_ms = j.value("time_ms", 0);
+            game_hashes = j.value("game_hashes", std::vector<uint64_t>{});
+        } catch (const nlohmann::json::exception&) {
+            res.status = 400;
+            res.set_content(R"({"error":"invalid JSON or missing fields"})", "application/json");
+            return;
+        }
+        if (depth < 1 || depth > 64 || alpha >= beta) {
+            res.status = 400;
+            res.set_content(R"({"error":"depth must be 1-64 and alpha below beta"})", "application/json");
+            return;
+        }
+
+        Board board;
+        try {
+            board.setup_with_fen(fen);
+        } catch (...) {
             res.status = 400;
             res.set_content(R"({"error":"failed to parse FEN"})", "application/json");
             return;
         }
+        std::vector<Move> moves;
+        for (const std::string& uci : uci_moves) {
+            Move m = board.parse_uci_move(uci);
+            if (m == Move()) {
+                res.status = 400;
+                res.set_content(R"({"error":"illegal move"})", "application/json");
+                return;
+            }
+            moves.push_back(m);
+        }
+
+        std::shared_ptr<SearchLane::Permit> permit;
+        if (!admit_search(req, res, SearchPriority::BOT, deadline, permit)) return;
+        deadline.clamp(limits);
+
+        // Run from the content provider, where the sink shows a coordinator that
+        // gave up and hung up; the search stops then rather than at its budget.
+        PackedPosition pos = board.pack();
+        res.set_chunked_content_provider("application/json",
+            [pos, moves, game_hashes, depth, alpha, beta, limits, permit](size_t /*offset*/, httplib::DataSink& sink) mutable {
+                Board board;
+                board.setup_with_packed(pos);
+                std::atomic<bool> cancel{false};
+                std::atomic<bool> finished{false};
+                limits.cancel          = &cancel;
+                limits.game_hashes     = game_hashes.data();
+                limits.game_hash_count = static_cast<int>(game_hashes.size());
+                std::thread watch([&] {
+                    while (!finished.load()) {
+                        if (!sink.is_writable()) { cancel.store(true); return; }
+                        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                    }
+                });
 
-        res.set_content(result, "application/json");
+                std::vector<int> scores(moves.size());
+                int nodes = 0;
+                g_searches_in_flight.fetch_add(1);
+                int done = search_root_moves(board, moves.data(), static_cast<int>(moves.size()), depth,
+                                             alpha, beta, limits, scores.data(), nodes);
+                g_searches_in_flight.fetch_sub(1);
+                finished.store(true);
+                watch.join();
+                if (cancel.load()) return false;
+
+                std::string& buf = response_buffer();
+                JsonWriter w(buf);
+                w.begin_object().field("nodes", nodes).key("scores").begin_array();
+                for (int i = 0; i < done; i++) w.value(scores[i]);
+                w.end_array().end_object();
+                sink.write(buf.data(), buf.size());
+                sink.done();
+                return false;
+            });
     });
 
     svr.Get("/stats", [](const httplib::Request& /*req*/, httplib::Response& res) {
@@ -97,33 +607,163 @@ int main() {
         nlohmann::json snap;
         snap["hostname"]           = std::string(hostname_buf);
         snap["cpu_percent"]        = g_cpu_percent_x10.load() / 10.0;
+        snap["foreground_cpu_percent"] = g_foreground_cpu_percent_x10.load() / 10.0;
+        CpuLimits cpu_limits = read_cpu_limits();
+        snap["cpu_limits"] = {
+            {"cpus",        g_cpu_capacity_x100.load() / 100.0},
+            {"cpuset_cpus", cpu_limits.cpuset_cpus},
+            {"quota_cpus",  cpu_limits.quota_cpus},
+        };
         snap["searches_in_flight"] = g_searches_in_flight.load();
+        snap["search_jobs"]        = search_jobs().size();
+        SearchCoalescer::Snapshot shared = search_coalescer().snapshot();
+        snap["coalesced_searches"] = {
+            {"followers",   shared.followers},
+            {"joined",      shared.joined},
+            {"running",     shared.searches},
+            {"subscribers", shared.subscribers},
+        };
+        ResultCache::Snapshot cache = result_cache().snapshot();
+        long long lookups = cache.hits + cache.misses;
+        snap["result_cache"] = {
+            {"capacity", cache.capacity},
+            {"entries",  cache.entries},
+            {"hit_rate", lookups > 0 ? static_cast<double>(cache.hits) / lookups : 0.0},
+            {"hits",     cache.hits},
+            {"misses",   cache.misses},
+        };
+        TTInfo tt = tt_info();
+        size_t tt_bytes = tt_resident_bytes();
+        GameSessionStore::Snapshot games = game_sessions().snapshot();
+        MemoryGovernorStats memory = memory_governor_stats();
+        snap["memory"] = {
+            {"components", {
+                {"game_sessions_bytes", games.bytes},
+                {"result_cache_bytes",  cache.bytes},
+                {"tt_bytes",            tt_bytes},
+            }},
+            {"current_bytes",    memory.pressure.current_bytes},
+            {"governor",         memory.enabled},
+            {"grows",            memory.grows},
+            {"limit_bytes",      memory.pressure.limit_bytes},
+            {"oom_kills",        memory.pressure.oom_kills},
+            {"psi_some_avg10",   memory.pressure.some_avg10},
+            {"rss_bytes",        process_rss_bytes()},
+            {"shrink_step",      memory.step},
+            {"shrinks",          memory.shrinks},
+            {"working_bytes",    memory.pressure.working_bytes},
+        };
+        snap["tt"] = {
+            {"entries",        tt.entries},
+            {"resident_bytes", tt_bytes},
+            {"shared",         tt.shared},
+        };
+        TTSnapshotStats snapshots = tt_snapshot_stats();
+        snap["tt_snapshot"] = {
+            {"enabled",      snapshots.enabled},
+            {"failures",     snapshots.failures},
+            {"last_entries", snapshots.last_entries},
+            {"last_save_ms", snapshots.last_save_ms},
+            {"restored",     snapshots.restored},
+            {"saves",        snapshots.saves},
+        };
+        DistributedTTStats dtt = distributed_tt_stats();
+        snap["distributed_tt"] = {
+            {"datagrams_sent", dtt.datagrams_sent},
+            {"dropped",        dtt.dropped},
+            {"enabled",        dtt.enabled},
+            {"peers",          dtt.peers},
+            {"published",      dtt.published},
+            {"received",       dtt.received},
+            {"rejected",       dtt.rejected},
+        };
+        Ponderer::Snapshot pondering = ponder().snapshot();
+        snap["ponder"] = {
+            {"hits",       pondering.hits},
+            {"misses",     pondering.misses},
+            {"preempted",  pondering.preempted},
+            {"skipped",    pondering.skipped},
+            {"started",    pondering.started},
+            {"tt_answers", pondering.tt_answers},
+        };
+        snap["game_sessions"] = {
+            {"created",      games.created},
+            {"evicted",      games.evicted},
+            {"expired",      games.expired},
+            {"max_sessions", games.max_sessions},
+            {"sessions",     games.sessions},
+        };
+        OverloadGovernor::Snapshot degraded = overload().snapshot();
+        snap["overload"] = {
+            {"active",           degraded.active},
+            {"shallow_searches", degraded.shallow_searches},
+            {"tt_answers",       degraded.tt_answers},
+        };
+        SearchLane::Snapshot lane  = search_lane().snapshot();
+        snap["search_lane"] = {
+            {"background",  lane.background},
+            {"concurrency", search_lane().config().concurrency},
+            {"queue_depth", search_lane().config().queue_depth},
+            {"queued",      lane.queued},
+            {"rejected",    lane.rejected},
+            {"running",     lane.running},
+        };
+        RootSplitStats split = root_split_stats();
+        snap["root_split"] = {
+            {"peer_batches",  split.peer_batches},
+            {"peer_failures", split.peer_failures},
+            {"peers",         split.peers},
+            {"researches",    split.researches},
+            {"searches",      split.searches},
+        };
+        if (SearchScheduler* sched = search_scheduler()) {
+            SearchScheduler::Snapshot turns = sched->snapshot();
+            snap["search_scheduler"] = {
+                {"cores",    turns.cores},
+                {"running",  turns.running},
+                {"switches", turns.switches},
+                {"waiting",  turns.waiting},
+            };
+        }
+        snap["placement"] = {
+            {"numa_nodes",  numa_topology().node_cpus.size()},
+            {"pinned_cpus", search_scheduler() ? search_scheduler()->config().pin_cpus.size() : 0},
+            {"tt_numa",     g_tt_numa},
+        };
+        SearchSocketStats sockets = search_socket_stats();
+        snap["search_sockets"] = {
+            {"searches", sockets.searches},
+            {"sessions", sockets.sessions},
+        };
         res.set_header("Cache-Control", "no-cache");
         res.set_content(snap.dump(), "application/json");
     });
 
     svr.Post("/search", [](const httplib::Request& req, httplib::Response& res) {
-        nlohmann::json body;
-        try {
-            body = nlohmann::json::parse(req.body);
-        } catch (const nlohmann::json::parse_error&) {
-            res.status = 400;
-            res.set_content(R"({"error":"invalid JSON"})", "application/json");
-            return;
-        }
-
-        if (!body.contains("fen")) {
-            res.status = 400;
-            res.set_content(R"({"error":"missing fen"})", "application/json");
-            return;
+        Deadline deadline;
+        if (!read_deadline(req, res, deadline)) return;
+        EngineRequest body;
+        switch (parse_search_request(req.body, body)) {
+            case ParseStatus::INVALID_JSON:
+                res.status = 400;
+                res.set_content(R"({"error":"invalid JSON"})", "application/json");
+                return;
+            case ParseStatus::MISSING_FIELD:
+                res.status = 400;
+                res.set_content(R"({"error":"missing fen"})", "application/json");
+                return;
+            case ParseStatus::OK:
+                break;
         }
 
-        std::string fen = body["fen"].get<std::string>();
-        int depth = body.value("depth", 4);
-        int noise = body.value("noise", 0);
-        int time_ms = body.value("time_ms", 0);
+        std::string fen(body.fen);
+        SearchLimits limits;
+        limits.depth     = body.depth;
+        limits.noise     = body.noise;
+        limits.time_ms   = body.time_ms;
+        limits.max_nodes = body.max_nodes;
 
-        if (depth < 1 || depth > 64) {
+        if (limits.depth < 1 || limits.depth > 64) {
             res.status = 400;
             res.set_content(R"({"error":"depth must be 1-64"})", "application/json");
             return;
@@ -132,13 +772,8 @@ int main() {
         // Opening book: return instantly if we have a book move.
         std::string book_move = book_lookup(fen);
         if (!book_move.empty()) {
-            nlohmann::json resp;
-            resp["best_move"] = book_move;
-            resp["score"] = 0;
-            resp["depth"] = 0;
-            resp["nodes"] = 0;
-            resp["book"] = true;
-            res.set_content(resp.dump(), "application/json");
+            std::string& buf = search_json({.best_move = book_move, .book = true});
+            res.set_content(buf.data(), buf.size(), "application/json");
             return;
         }
 
@@ -151,42 +786,81 @@ int main() {
             return;
         }
 
-        g_searches_in_flight.fetch_add(1);
-        SearchResult result = search(board, depth, noise, time_ms);
-        g_searches_in_flight.fetch_sub(1);
+        // Cache hits and requests joining an identical running search don't need a
+        // search lane slot.
+        ResultKey key = make_result_key(board.get_hash(), limits);
+        SearchResult result;
+        bool cached, degraded;
+        if (!answer_without_search(board, limits, key, result, cached, degraded)) {
+            bool created = false;
+            auto sub = search_coalescer().join(key, false, created);
+            std::shared_ptr<SearchLane::Permit> permit;
+            if (!sub) {
+                if (!admit_search(req, res, SearchPriority::BOT, deadline, permit)) return;
+                sub = search_coalescer().join(key, true, created);
+            }
+            SharedSearch& shared = sub->search();
 
-        nlohmann::json resp;
-        resp["best_move"] = result.best_move.to_uci();
-        resp["score"] = result.score;
-        resp["depth"] = result.depth_completed;
-        resp["nodes"] = result.nodes;
-        if (time_ms > 0) resp["time_ms"] = time_ms;
-        res.set_content(resp.dump(), "application/json");
-    });
+            if (created) {
+                limits.cancel = shared.cancel_flag();
+                // Clamped after the queue wait, so the search gets what is left.
+                bool cut = deadline.clamp(limits);
+                g_searches_in_flight.fetch_add(1);
+                result = split_search(board, limits);
+                g_searches_in_flight.fetch_sub(1);
 
-    svr.Post("/search-stream", [](const httplib::Request& req, httplib::Response& res) {
-        nlohmann::json body;
-        try {
-            body = nlohmann::json::parse(req.body);
-        } catch (const nlohmann::json::parse_error&) {
-            res.status = 400;
-            res.set_content(R"({"error":"invalid JSON"})", "application/json");
-            return;
+                bool complete = !shared.cancelled() && !cut;
+                shared.finish(result);
+                search_coalescer().remove(key, &shared);
+                if (complete && ResultCache::cacheable(limits)) result_cache().store(key, result);
+            } else {
+                // A permit taken before the search turned up is kept while following
+                // (see SearchCoalescer.h).
+                size_t next = 0;
+                std::vector<DepthEvent> ignored;
+                while (!shared.wait(next, ignored, result, 1000)) {
+                    if (deadline.expired()) {
+                        res.status = 504;
+                        res.set_content(R"({"error":"deadline exceeded"})", "application/json");
+                        return;
+                    }
+                }
+            }
         }
 
-        if (!body.contains("fen")) {
-            res.status = 400;
-            res.set_content(R"({"error":"missing fen"})", "application/json");
-            return;
+        std::string best_move = result.best_move.to_uci();
+        std::string& buf = search_json({.best_move = best_move, .score = result.score,
+                                        .depth = result.depth_completed, .nodes = result.nodes,
+                                        .cached = cached, .degraded = degraded, .time_ms = limits.time_ms});
+        res.set_content(buf.data(), buf.size(), "application/json");
+    });
+
+    svr.Post("/search-stream", [](const httplib::Request& req, httplib::Response& res) {
+        Deadline deadline;
+        if (!read_deadline(req, res, deadline)) return;
+        EngineRequest body;
+        switch (parse_search_request(req.body, body)) {
+            case ParseStatus::INVALID_JSON:
+                res.status = 400;
+                res.set_content(R"({"error":"invalid JSON"})", "application/json");
+                return;
+            case ParseStatus::MISSING_FIELD:
+                res.status = 400;
+                res.set_content(R"({"error":"missing fen"})", "application/json");
+                return;
+            case ParseStatus::OK:
+                break;
         }
 
         // Capture request params before entering the content provider.
-        std::string fen = body["fen"].get<std::string>();
-        int depth   = body.value("depth", 4);
-        int noise   = body.value("noise", 0);
-        int time_ms = body.value("time_ms", 0);
+        std::string fen(body.fen);
+        SearchLimits limits;
+        limits.depth     = body.depth;
+        limits.noise     = body.noise;
+        limits.time_ms   = body.time_ms;
+        limits.max_nodes = body.max_nodes;
 
-        if (depth < 1 || depth > 64) {
+        if (limits.depth < 1 || limits.depth > 64) {
             res.status = 400;
             res.set_content(R"({"error":"depth must be 1-64"})", "application/json");
             return;
@@ -197,14 +871,7 @@ int main() {
         if (!book_move.empty()) {
             res.set_chunked_content_provider("text/event-stream",
                 [book_move](size_t /*offset*/, httplib::DataSink& sink) {
-                    nlohmann::json ev;
-                    ev["best_move"] = book_move;
-                    ev["score"] = 0;
-                    ev["depth"] = 0;
-                    ev["nodes"] = 0;
-                    ev["book"] = true;
-                    ev["done"] = true;
-                    std::string line = "data: " + ev.dump() + "\n\n";
+                    std::string& line = search_event({.best_move = book_move, .book = true, .done = true});
                     sink.write(line.data(), line.size());
                     sink.done();
                     return false;
@@ -213,6 +880,9 @@ int main() {
         }
 
         // Validate FEN before entering the content provider.
+        ResultKey key;
+        SearchResult early;
+        bool cached, degraded, answered;
         {
             Board test_board;
             try {
@@ -222,48 +892,540 @@ int main() {
                 res.set_content(R"({"error":"failed to parse FEN"})", "application/json");
                 return;
             }
+            key = make_result_key(test_board.get_hash(), limits);
+            answered = answer_without_search(test_board, limits, key, early, cached, degraded);
+        }
+
+        // Cache hit or TT answer: a single final event, like a book move.
+        if (answered) {
+            res.set_chunked_content_provider("text/event-stream",
+                [early, cached, degraded](size_t /*offset*/, httplib::DataSink& sink) {
+                    std::string best_move = early.best_move.to_uci();
+                    std::string& line = search_event({.best_move = best_move, .score = early.score,
+                                                      .depth = early.depth_completed, .nodes = early.nodes,
+                                                      .cached = cached, .degraded = degraded, .done = true});
+                    sink.write(line.data(), line.size());
+                    sink.done();
+                    return false;
+                });
+            return;
+        }
+
+        // Identical search already running: follow it instead of starting another.
+        bool created = false;
+        auto sub = search_coalescer().join(key, false, created);
+        // The permit rides along with the provider and is released with it.
+        std::shared_ptr<SearchLane::Permit> permit;
+        if (!sub) {
+            if (!admit_search(req, res, SearchPriority::BOT, deadline, permit)) return;
+            sub = search_coalescer().join(key, true, created);
+        }
+        if (!created) {
+            stream_shared_search(res, std::move(sub), std::move(permit));
+            return;
         }
 
         res.set_chunked_content_provider("text/event-stream",
-            [fen, depth, noise, time_ms](size_t /*offset*/, httplib::DataSink& sink) mutable {
+            [fen, limits, key, deadline, degraded, permit, sub](size_t /*offset*/, httplib::DataSink& sink) mutable {
                 Board board;
                 board.setup_with_fen(fen);
-                // Abort search early if the client disconnects.
-                std::atomic<bool> client_gone{false};
-
-                DepthCallback cb = [&sink, &client_gone](int d, const std::string& best_move, int score, int nodes) -> bool {
-                    if (!sink.is_writable()) { client_gone.store(true); return false; }
-                    nlohmann::json ev;
-                    ev["depth"] = d;
-                    ev["best_move"] = best_move;
-                    ev["score"] = score;
-                    ev["nodes"] = nodes;
-                    std::string line = "data: " + ev.dump() + "\n\n";
+                SharedSearch& shared = sub->search();
+                limits.cancel = shared.cancel_flag();
+                bool cut = deadline.clamp(limits);
+
+                // Events go to every subscriber through the shared search. If this
+                // client disconnects the search carries on for the others, and is
+                // cancelled once nobody is left.
+                DepthCallback cb = [&sink, &sub, &shared](int d, const std::string& best_move, int score, int nodes) -> bool {
+                    shared.publish({d, best_move, score, nodes});
+                    if (!sink.is_writable()) {
+                        sub->leave();
+                        return true;
+                    }
+                    std::string& line = search_event({.best_move = best_move, .score = score,
+                                                      .depth = d, .nodes = nodes});
                     sink.write(line.data(), line.size());
                     return true;
                 };
 
                 g_searches_in_flight.fetch_add(1);
-                SearchResult result = search(board, depth, noise, time_ms, cb);
+                SearchResult result = split_search(board, limits, cb);
                 g_searches_in_flight.fetch_sub(1);
 
-                if (client_gone.load() || !sink.is_writable()) return false;
+                bool complete = !shared.cancelled() && !cut;
+                shared.finish(result);
+                search_coalescer().remove(key, &shared);
+                if (complete && ResultCache::cacheable(limits)) result_cache().store(key, result);
+
+                if (!sink.is_writable()) {
+                    sub->leave();
+                    return false;
+                }
 
                 // Final event with done flag.
-                nlohmann::json ev;
-                ev["depth"] = result.depth_completed;
-                ev["best_move"] = result.best_move.to_uci();
-                ev["score"] = result.score;
-                ev["nodes"] = result.nodes;
-                ev["done"] = true;
-                std::string line = "data: " + ev.dump() + "\n\n";
+                std::string best_move = result.best_move.to_uci();
+                std::string& line = search_event({.best_move = best_move, .score = result.score,
+                                                  .depth = result.depth_completed, .nodes = result.nodes,
+                                                  .degraded = degraded, .done = true});
+                sink.write(line.data(), line.size());
+                sink.done();
+                sub->leave();
+                return false;
+            });
+    });
+
+    // Bot games: validate and apply the human move, then search the bot's reply on
+    // the same board and apply it as well -- one request, one FEN parse, one replica.
+    // Streams SSE events:
+    //   1. {"game_state","new_fen","status"} once the human move is applied
+    //   2. per-depth search events, exactly as /search-stream sends them
+    //   3. a final done event repeating the human result plus best_move, bot_fen
+    //      and bot_game_state
+    // An illegal move yields a single {"done":true,"status":"INVALID"} event. A move
+    // that ends the game yields its result with done set and no reply.
+    // With a game_id the turn continues that game's session (GameSessions.h) and
+    // fen may be omitted; without a live session such a request gets a 409. Such
+    // turns also ponder (Ponder.h), and the done event then says whether the human
+    // move was the expected one ("ponder":"hit"|"miss").
+    svr.Post("/move-and-reply", [](const httplib::Request& req, httplib::Response& res) {
+        Deadline deadline;
+        if (!read_deadline(req, res, deadline)) return;
+        EngineRequest body;
+        switch (parse_turn_request(req.body, body)) {
+            case ParseStatus::INVALID_JSON:
+                res.status = 400;
+                res.set_content(R"({"error":"invalid JSON"})", "application/json");
+                return;
+            case ParseStatus::MISSING_FIELD:
+                res.status = 400;
+                res.set_content(R"({"error":"missing fen or uci_move"})", "application/json");
+                return;
+            case ParseStatus::OK:
+                break;
+        }
+
+        int depth   = body.depth;
+        int noise   = body.noise;
+        int time_ms = body.time_ms;
+
+        if (depth < 1 || depth > 64) {
+            res.status = 400;
+            res.set_content(R"({"error":"depth must be 1-64"})", "application/json");
+            return;
+        }
+
+        // Without a game_id the turn runs in a throwaway session, so both paths
+        // share the code below. The session's lock is held until the provider is
+        // done with its board. A turn without a fen can only continue a session, so
+        // it never creates one (unknown ids would evict real games).
+        bool stored = !body.game_id.empty();
+        std::shared_ptr<GameSession> session;
+        if (!stored) session = std::make_shared<GameSession>();
+        else if (body.fen.empty()) session = game_sessions().find(std::string(body.game_id));
+        else session = game_sessions().get(std::string(body.game_id));
+        if (!session) {
+            res.status = 409;
+            res.set_content(R"({"error":"no session for game_id, send fen"})", "application/json");
+            return;
+        }
+        ponder().stop(*session);
+        auto turn = std::make_shared<std::unique_lock<std::mutex>>(session->mu);
+        if (!session->synced || (!body.fen.empty() && body.fen != session->fen)) {
+            if (body.fen.empty()) {
+                res.status = 409;
+                res.set_content(R"({"error":"no session for game_id, send fen"})", "application/json");
+                return;
+            }
+            if (!session->reset(std::string(body.fen))) {
+                res.status = 400;
+                res.set_content(R"({"error":"failed to parse FEN"})", "application/json");
+                return;
+            }
+        }
+        session->reroot();
+        Move human = session->board->parse_uci_move(body.uci_move);
+
+        // An illegal move is answered without searching, so it needs no permit. A
+        // legal one is applied and reported even when the lane refuses the reply's
+        // search; only the final event then says the reply was refused.
+        std::shared_ptr<SearchLane::Permit> permit;
+        Admission admission = human == Move() ? Admission::ADMITTED
+                                              : acquire_search(req, res, SearchPriority::BOT, deadline, permit);
+        Refusal refused = admission == Admission::ADMITTED ? Refusal{0, nullptr} : refusal(admission, deadline);
+
+        // Out of sync until the provider has applied the turn; see GameSessions.h.
+        session->synced = false;
+        res.set_chunked_content_provider("text/event-stream",
+            [session, stored, turn, human, depth, noise, time_ms, deadline, permit, refused](size_t /*offset*/, httplib::DataSink& sink) {
+                Board& board = *session->board;
+                if (human == Move()) {
+                    session->synced = true;
+                    std::string& line = response_buffer();
+                    line += "data: ";
+                    JsonWriter(line).begin_object().field("done", true).field("status", "INVALID").end_object();
+                    line += "\n\n";
+                    sink.write(line.data(), line.size());
+                    sink.done();
+                    return false;
+                }
+
+                session->play(human);
+                TurnReport report;
+                report.ponder = ponder().outcome(*session, human);
+                report.game_state = classify_game_state(board);
+                char human_fen[FEN_MAX_LENGTH];
+                report.new_fen = std::string_view(human_fen, board.write_fen(human_fen));
+
+                if (report.game_state != GameState::ACTIVE || refused.error) {
+                    report.error = refused.error;
+                    report.retry_after = refused.error && refused.status != 504 ? 1 : 0;
+                    session->fen = report.new_fen;
+                    session->synced = true;
+                    std::string& line = turn_event(report);
+                    sink.write(line.data(), line.size());
+                    sink.done();
+                    return false;
+                }
+
+                {
+                    std::string& line = response_buffer();
+                    line += "data: ";
+                    JsonWriter(line).begin_object()
+                        .field("game_state", game_state_name(report.game_state))
+                        .field("new_fen", report.new_fen)
+                        .field("status", "VALID")
+                        .end_object();
+                    line += "\n\n";
+                    sink.write(line.data(), line.size());
+                }
+
+                // Opening book first, then a full search, as /search-stream does.
+                report.searched = true;
+                std::string best_move = book_lookup(std::string(report.new_fen));
+                if (!best_move.empty()) {
+                    report.book = true;
+                } else {
+                    SearchLimits limits;
+                    limits.depth   = depth;
+                    limits.noise   = noise;
+                    limits.time_ms = time_ms;
+                    // Before any answer is looked up, so history-blind ones are skipped.
+                    session->prepare(limits);
+                    ResultKey key = make_result_key(board.get_hash(), limits);
+                    SearchResult result;
+                    bool answered = answer_without_search(board, limits, key, result,
+                                                          report.cached, report.degraded);
+                    // On a ponder hit this position was searched while the human
+                    // thought; if that went deep enough, its TT entry is the answer.
+                    if (!answered && report.ponder == PonderOutcome::HIT && limits.noise == 0 &&
+                        tt_result(board, limits.depth, result)) {
+                        answered = true;
+                        ponder().count_tt_answer();
+                    }
+                    bool cacheable = ResultCache::cacheable(limits);
+                    bool cut = deadline.clamp(limits);
+
+                    std::atomic<bool> client_gone{false};
+                    DepthCallback cb = [&sink, &client_gone](int d, const std::string& mv, int score, int nodes) -> bool {
+                        if (!sink.is_writable()) { client_gone.store(true); return false; }
+                        std::string& line = search_event({.best_move = mv, .score = score,
+                                                          .depth = d, .nodes = nodes});
+                        sink.write(line.data(), line.size());
+                        return true;
+                    };
+
+                    if (!answered) {
+                        g_searches_in_flight.fetch_add(1);
+                        result = split_search(board, limits, cb);
+                        g_searches_in_flight.fetch_sub(1);
+
+                        if (client_gone.load() || !sink.is_writable()) return false;
+                        // Game history can turn a line into a repetition draw, which
+                        // a search of the same position in another game wouldn't see.
+                        if (cacheable && !cut && limits.game_hash_count == 0) result_cache().store(key, result);
+                    }
+
+                    if (result.depth_completed > 0) best_move = result.best_move.to_uci();
+                    report.depth = result.depth_completed;
+                    report.nodes = result.nodes;
+                    report.score = result.score;
+                }
+
+                char bot_fen[FEN_MAX_LENGTH];
+                Move reply = best_move.empty() ? Move() : board.parse_uci_move(best_move);
+                if (reply != Move()) {
+                    session->play(reply);
+                    report.best_move = best_move;
+                    report.bot_game_state = classify_game_state(board);
+                    report.bot_fen = std::string_view(bot_fen, board.write_fen(bot_fen));
+                }
+                session->fen = reply != Move() ? report.bot_fen : report.new_fen;
+                session->synced = true;
+                if (stored && reply != Move() && report.bot_game_state == GameState::ACTIVE) ponder().start(session);
+
+                std::string& line = turn_event(report);
                 sink.write(line.data(), line.size());
                 sink.done();
                 return false;
             });
     });
 
-    std::cout << "Chess engine listening on 0.0.0.0:8081\n";
-    svr.listen("0.0.0.0", 8081);
+    // Asynchronous search jobs: POST /jobs submits a search (same body as /search,
+    // plus an optional job_id) and answers 202 with the job's status. Submitting a
+    // job_id that is still running or recently finished reattaches to that job
+    // (200) rather than searching again; different parameters under the same id
+    // are a 409. GET /jobs/{id} polls depth, nodes, PV and finally the result;
+    // DELETE /jobs/{id} cancels. Finished jobs are kept for ENGINE_JOB_TTL_MS.
+    // X-Deadline-Ms bounds only the submit: jobs exist to outlive their request.
+    svr.Post("/jobs", [](const httplib::Request& req, httplib::Response& res) {
+        Deadline deadline;
+        if (!read_deadline(req, res, deadline)) return;
+        EngineRequest body;
+        switch (parse_search_request(req.body, body)) {
+            case ParseStatus::INVALID_JSON:
+                res.status = 400;
+                res.set_content(R"({"error":"invalid JSON"})", "application/json");
+                return;
+            case ParseStatus::MISSING_FIELD:
+                res.status = 400;
+                res.set_content(R"({"error":"missing fen"})", "application/json");
+                return;
+            case ParseStatus::OK:
+                break;
+        }
+
+        if (body.depth < 1 || body.depth > 64) {
+            res.status = 400;
+            res.set_content(R"({"error":"depth must be 1-64"})", "application/json");
+            return;
+        }
+        if (!body.job_id.empty() && !valid_job_id(body.job_id)) {
+            res.status = 400;
+            res.set_content(R"({"error":"job_id must be 1-64 characters of A-Z, a-z, 0-9, _ or -"})", "application/json");
+            return;
+        }
+
+        std::string id(body.job_id);
+        JobParams params{std::string(body.fen), body.depth, body.noise, body.time_ms, body.max_nodes};
+
+        auto reply = [&res, &params](const std::shared_ptr<SearchJob>& job, bool started) {
+            if (job->params() != params) {
+                res.status = 409;
+                res.set_content(R"({"error":"job_id already used with different parameters"})", "application/json");
+                return;
+            }
+            res.status = started ? 202 : 200;
+            std::string& buf = job_json(job->id(), job->status());
+            res.set_content(buf.data(), buf.size(), "application/json");
+        };
+
+        // Reattaching needs neither a FEN parse nor a search lane slot.
+        if (!id.empty()) {
+            if (auto job = search_jobs().find(id)) {
+                reply(job, false);
+                return;
+            }
+        }
+
+        {
+            Board test_board;
+            try {
+                test_board.setup_with_fen(params.fen);
+            } catch (...) {
+                res.status = 400;
+                res.set_content(R"({"error":"failed to parse FEN"})", "application/json");
+                return;
+            }
+        }
+
+        std::shared_ptr<SearchLane::Permit> permit;
+        if (!admit_search(req, res, SearchPriority::BOT, deadline, permit)) return;
+
+        bool started = false;
+        auto job = search_jobs().start(id, params, std::move(permit), started);
+        reply(job, started);
+    });
+
+    svr.Get(R"(/jobs/([A-Za-z0-9_-]+))", [](const httplib::Request& req, httplib::Response& res) {
+        auto job = search_jobs().find(req.matches[1]);
+        if (!job) {
+            res.status = 404;
+            res.set_content(R"({"error":"job not found"})", "application/json");
+            return;
+        }
+        res.set_header("Cache-Control", "no-cache");
+        std::string& buf = job_json(job->id(), job->status());
+        res.set_content(buf.data(), buf.size(), "application/json");
+    });
+
+    svr.Delete(R"(/jobs/([A-Za-z0-9_-]+))", [](const httplib::Request& req, httplib::Response& res) {
+        auto job = search_jobs().find(req.matches[1]);
+        if (!job) {
+            res.status = 404;
+            res.set_content(R"({"error":"job not found"})", "application/json");
+            return;
+        }
+        job->cancel();
+        std::string& buf = job_json(job->id(), job->status());
+        res.set_content(buf.data(), buf.size(), "application/json");
+    });
+}
+
+int main() {
+    std::srand(static_cast<unsigned>(std::time(nullptr)));
+
+    // One TT for every engine process on the host (see tt_attach_shared). The size
+    // only applies to whichever process creates the table.
+    if (const char* shared = std::getenv("ENGINE_TT_SHARED"); shared && *shared) {
+        size_t entries = 1;
+        size_t wanted = static_cast<size_t>(std::max(1, env_int("ENGINE_TT_MB", 256))) * (1 << 20) / sizeof(TTEntry);
+        while (entries * 2 <= wanted) entries *= 2;
+        std::string error;
+        if (tt_attach_shared(shared, entries, error)) {
+            std::cout << "Shared TT " << shared << ": " << tt_info().entries << " entries\n";
+        } else {
+            std::cerr << "Shared TT " << shared << " unavailable (" << error << "), using a private table\n";
+        }
+    }
+
+    // NUMA placement of the TT, before the snapshot restore and searches touch it.
+    init_placement();
+    if (const char* policy = std::getenv("ENGINE_TT_NUMA"); policy && *policy) {
+        std::string error;
+        if (place_tt_memory(policy, error)) {
+            g_tt_numa = policy;
+        } else {
+            std::cerr << "TT NUMA placement " << policy << " not applied: " << error << "\n";
+        }
+    }
+
+    // Warm start from the last snapshot; first, so later threads inherit its signal mask.
+    TTSnapshotConfig snapshot_cfg;
+    if (const char* path = std::getenv("ENGINE_TT_SNAPSHOT")) snapshot_cfg.path = path;
+    snapshot_cfg.min_depth  = env_int("ENGINE_TT_SNAPSHOT_DEPTH", 6);
+    snapshot_cfg.interval_s = env_int("ENGINE_TT_SNAPSHOT_INTERVAL_S", 300);
+    start_tt_snapshots(snapshot_cfg);
+
+    // Pools follow the CPUs the container may use (cgroup quota and cpuset), not
+    // the host's core count.
+    CpuLimits cpu_limits = read_cpu_limits();
+    int cpus = std::max(1, static_cast<int>(std::ceil(cpu_limits.effective())));
+    std::cout << "CPU capacity " << cpu_limits.effective() << " (quota "
+              << (cpu_limits.quota_cpus > 0 ? std::to_string(cpu_limits.quota_cpus) : "none")
+              << ", cpuset " << cpu_limits.cpuset_cpus << ")\n";
+
+    // Searches compute on this many cores at a time and take turns at their clock
+    // checks (SearchScheduler.h); 0 leaves every admitted search to the OS.
+    SearchSchedulerConfig sched_cfg;
+    sched_cfg.cores              = env_int("ENGINE_SCHED_CORES", cpus);
+    sched_cfg.slice_ms           = env_int("ENGINE_SCHED_SLICE_MS", 10);
+    sched_cfg.untimed_horizon_ms = env_int("ENGINE_SCHED_UNTIMED_HORIZON_MS", 5000);
+    if (env_int("ENGINE_CPU_PIN", 0) != 0) sched_cfg.pin_cpus = placement_cpus();
+    init_search_scheduler(sched_cfg);
+    // Unless pinned by ENGINE_SCHED_CORES, the scheduler follows quota changes.
+    bool follow_quota = std::getenv("ENGINE_SCHED_CORES") == nullptr;
+    std::thread(track_cpu, [follow_quota](int now_cpus) {
+        std::cout << "CPU capacity changed to " << g_cpu_capacity_x100.load() / 100.0 << "\n";
+        if (SearchScheduler* sched = search_scheduler(); sched && follow_quota) sched->set_cores(now_cpus);
+    }).detach();
+
+    // Search lane: bounded concurrency and queue shared by every listener. With the
+    // scheduler on, admitted searches only wait for a core, so admit more of them.
+    SearchLaneConfig lane_cfg;
+    lane_cfg.concurrency      = env_int("ENGINE_SEARCH_CONCURRENCY", sched_cfg.cores > 0 ? 4 * cpus : std::max(2, cpus));
+    lane_cfg.queue_depth      = env_int("ENGINE_SEARCH_QUEUE", 16);
+    lane_cfg.queue_timeout_ms = env_int("ENGINE_SEARCH_QUEUE_TIMEOUT_MS", 2000);
+    init_search_lane(lane_cfg);
+
+    if (const char* id = std::getenv("ENGINE_REPLICA_ID"); id && *id) {
+        g_replica_id = id;
+    } else {
+        char hostname_buf[256] = {};
+        gethostname(hostname_buf, sizeof(hostname_buf));
+        g_replica_id = hostname_buf;
+    }
+    init_search_jobs(env_int("ENGINE_JOB_TTL_MS", 60000));
+    init_result_cache(static_cast<size_t>(std::max(0, env_int("ENGINE_RESULT_CACHE_ENTRIES", 65536))));
+    PonderConfig ponder_cfg;
+    ponder_cfg.enabled = env_int("ENGINE_PONDER", 1) != 0;
+    ponder_cfg.time_ms = env_int("ENGINE_PONDER_TIME_MS", 30000);
+    init_ponder(ponder_cfg);
+    init_game_sessions(static_cast<size_t>(std::max(0, env_int("ENGINE_SESSION_MAX", 1024))),
+                       env_int("ENGINE_SESSION_TTL_MS", 600000));
+
+    // Shrink the TT, result cache and sessions under cgroup memory pressure.
+    MemoryGovernorConfig memory_cfg;
+    memory_cfg.enabled      = env_int("ENGINE_MEMORY_GOVERNOR", 1) != 0;
+    memory_cfg.pressure_pct = env_int("ENGINE_MEMORY_PRESSURE_PCT", 10);
+    memory_cfg.usage_pct    = env_int("ENGINE_MEMORY_USAGE_PCT", 90);
+    memory_cfg.relax_s      = env_int("ENGINE_MEMORY_RELAX_S", 30);
+    start_memory_governor(memory_cfg);
+
+    // Overload mode: degrade bot searches once the lane queue or CPU crosses these.
+    OverloadConfig overload_cfg;
+    overload_cfg.queue_threshold = env_int("ENGINE_OVERLOAD_QUEUE", std::max(1, lane_cfg.queue_depth / 4));
+    overload_cfg.cpu_percent     = env_int("ENGINE_OVERLOAD_CPU_PERCENT", 90);
+    overload_cfg.shallow_depth   = env_int("ENGINE_DEGRADED_DEPTH", 4);
+    overload_cfg.budget_percent  = env_int("ENGINE_DEGRADED_BUDGET_PERCENT", 25);
+    overload_cfg.tt_depth        = env_int("ENGINE_DEGRADED_TT_DEPTH", 6);
+    init_overload(overload_cfg);
+
+    // Deep TT entries shared with replicas on other hosts (off unless ENGINE_TT_PORT is set).
+    DistributedTTConfig dtt_cfg;
+    dtt_cfg.port          = env_int("ENGINE_TT_PORT", 0);
+    dtt_cfg.publish_depth = env_int("ENGINE_TT_PUBLISH_DEPTH", 8);
+    if (const char* peers = std::getenv("ENGINE_TT_PEERS")) dtt_cfg.peers = parse_peer_list(peers);
+    if (!start_distributed_tt(dtt_cfg)) return 1;
+
+    // Deep iterations split across peer replicas (off unless ENGINE_SPLIT_PEERS is set).
+    RootSplitConfig split_cfg;
+    split_cfg.split_depth   = env_int("ENGINE_SPLIT_DEPTH", 7);
+    split_cfg.peer_slack_ms = env_int("ENGINE_SPLIT_SLACK_MS", 1000);
+    if (const char* peers = std::getenv("ENGINE_SPLIT_PEERS")) split_cfg.peers = parse_peer_list(peers);
+    init_root_split(split_cfg);
+
+    // Binary framed protocol for co-located callers; HTTP below stays the default API.
+    BinaryServerConfig binary_cfg;
+    binary_cfg.tcp_port = env_int("ENGINE_BINARY_PORT", 8082);
+    if (const char* path = std::getenv("ENGINE_BINARY_SOCKET")) binary_cfg.unix_socket = path;
+    if (!start_binary_server(binary_cfg)) return 1;
+
+    // Default thread pool is max(8, hardware_concurrency-1) which queues under
+    // burst load. 32 threads per replica handles concurrent move validation
+    // without timeouts at high VU counts; a container with fewer CPUs can't run
+    // that many at once, so it gets 8 per CPU, at least 8. Searches running or
+    // queued in the lane, and followers of coalesced searches, get threads on top
+    // of those, so they can never take the latency lane's.
+    int latency_threads = env_int("ENGINE_HTTP_THREADS", std::clamp(8 * cpus, 8, 32));
+    int max_followers = std::max(0, env_int("ENGINE_SEARCH_FOLLOWERS", 16));
+    search_coalescer().set_max_followers(max_followers);
+    int pool_size = latency_threads + lane_cfg.concurrency + lane_cfg.queue_depth + max_followers;
+    // Overridable so several engines (e.g. split peers) can run on one host.
+    int http_port = env_int("ENGINE_HTTP_PORT", 8081);
+
+    // ENGINE_HTTP_SERVER=epoll: one event loop owns all sockets and the pool only
+    // runs handlers, so idle keep-alive and slow SSE clients don't pin threads.
+    const char* server_kind = std::getenv("ENGINE_HTTP_SERVER");
+    if (server_kind && std::string_view(server_kind) == "epoll") {
+        EpollServer svr(pool_size);
+        register_routes(svr);
+        // Multiplexed search sessions; see SearchSocket.h for the message protocol.
+        svr.WebSocket("/ws", [](const httplib::Request&, std::shared_ptr<WebSocketChannel> channel) {
+            auto session = std::make_shared<SearchSocketSession>(std::move(channel));
+            return WebSocketHandlers{
+                [session](std::string_view message) { session->on_message(message); },
+                [session] { session->on_close(); },
+            };
+        });
+        std::cout << "Chess engine listening on 0.0.0.0:" << http_port << " (epoll)\n";
+        return svr.listen("0.0.0.0", http_port) ? 0 : 1;
+    }
+
+    httplib::Server svr;
+    svr.new_task_queue = [pool_size] { return new httplib::ThreadPool(pool_size); };
+    register_routes(svr);
+
+    std::cout << "Chess engine listening on 0.0.0.0:" << http_port << "\n";
+    svr.listen("0.0.0.0", http_port);
     return 0;
 }